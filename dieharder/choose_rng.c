@@ -99,7 +99,19 @@ void choose_rng()
 int select_rng(int gennum,char *genname,unsigned int initial_seed)
 {
 
- int i;
+ int i,j;
+
+ /*
+  * Generators given as plugin:/path/to/lib.so[:args] are loaded now,
+  * and from here on are just numbers (so that XOR can use them too).
+  */
+ for(j=0;j<gvcount;j++){
+   if(strncmp(gnames[j],"plugin:",7) == 0){
+     if((i = dh_rng_plugin_load(gnames[j] + 7)) < 0) return(-1);
+     gnumbs[j] = i;
+     gnames[j][0] = 0;
+   }
+ }
 
  /*
   * REALLY out of bounds we can just test for and return an error.
@@ -178,7 +190,7 @@ int select_rng(int gennum,char *genname,unsigned int initial_seed)
    MYDEBUG(D_SEED){
      fprintf(stdout,"# choose_rng(): freeing old gennum %s\n",gsl_rng_name(rng));
    }
-   gsl_rng_free(rng);
+   dh_rng_free(rng);
    reset_bit_buffers();
  }
 
@@ -189,7 +201,11 @@ int select_rng(int gennum,char *genname,unsigned int initial_seed)
  MYDEBUG(D_SEED){
    fprintf(stdout,"# choose_rng(): Creating and seeding gennum %s\n",dh_rng_types[gennum]->name);
  }
- rng = gsl_rng_alloc(dh_rng_types[gennum]);
+ /*
+  * With -H low or -H high we actually test a wrapper that hands out
+  * just those halves of the generator's 64 bit words.
+  */
+ rng = gsl_rng_alloc(dh_rng_half64(dh_rng_types[gennum],half64));
 
  /*
   * Here we evaluate the speed of the generator if the rate flag is set.
@@ -358,7 +374,7 @@ int select_XOR()
    MYDEBUG(D_SEED){
      fprintf(stdout,"# choose_rng(): freeing old gennum %s\n",gsl_rng_name(rng));
    }
-   gsl_rng_free(rng);
+   dh_rng_free(rng);
    reset_bit_buffers();
  }
 
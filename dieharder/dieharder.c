@@ -90,6 +90,18 @@ int main(int argc, char *argv[])
      run_test();
    }
 
+   /*
+    * When reading stdin, say who kept whom waiting:  time the tests
+    * waited for input means the source is the bottleneck, time the
+    * input waited for the tests means dieharder is.
+    */
+   if(strncmp("stdin_input_raw",dh_rng_half64_inner(rng->type)->name,15) == 0){
+     double source_stall,test_stall;
+     stdin_input_get_stalls(rng,&source_stall,&test_stall);
+     fprintf(stderr,"# stdin_input_raw: tests waited %.2f s for input, input waited %.2f s for tests\n",source_stall,test_stall);
+     fflush(stderr);
+   }
+
  /*
   * This ends the core loop for a non-CLI interactive UI.  GUIs will
   * typically exit directly from the event loop.  Tool UIs may well fall
@@ -58,6 +58,9 @@ double strategy;
  void set_globals();
  void choose_rng();
  int execute_test(int);
+ unsigned int need_more_psamples(Dtest *dtest,Test **test);
+ void add_job(int dtest_num);
+ void run_jobs();
  void run_all_tests();
  void run_test();
  void add_ui_rngs();
@@ -52,7 +52,7 @@ Usage:\n\
 \n\
 dieharder [-a] [-d dieharder test number] [-f filename] [-B]\n\
           [-D output flag [-D output flag] ... ] [-F] [-c separator]\n\
-          [-g generator number or -1] [-h] [-k ks_flag] [-l] \n\
+          [-g generator number or -1] [-h] [-H half] [-j jobs] [-k ks_flag] [-l] \n\
           [-L overlap] [-m multiply_p] [-n ntuple] \n\
           [-p number of p samples] [-P Xoff]\n\
           [-o filename] [-s seed strategy] [-S random number seed]\n\
@@ -74,7 +74,11 @@ fprintf(stdout, "\n\
 \n\
      and then examine the contents of example.input.\n\
      Raw binary input reads 32 bit increments of the specified data stream.\n\
-     stdin_input_raw accepts a pipe from a raw binary stream.\n\
+     stdin_input_raw accepts a pipe from a raw binary stream, and reports\n\
+     at the end how long the tests waited for input and vice versa.\n\
+     shm_input (218) reads from the POSIX shared memory ring named by -f\n\
+     (e.g. -f /myrng) that a producer process fills with the routines\n\
+     in dieharder/dh_shm.h, without copying the data through a pipe.\n\
   -B binary output (used with -o)\n\
   -D output flag - permits fields to be selected for inclusion in dieharder\n\
      output.  Each flag can be entered as a binary number that turns\n\
@@ -84,8 +88,21 @@ fprintf(stdout, "\n\
   -c table separator - where separator is e.g. ',' (CSV) or ' ' (whitespace).\n\
   -g generator number - selects a specific generator for testing.  Using\n\
      -1 causes all known generators to be printed out to the display.\n\
+     -g plugin:/path/to/libmyrng.so[:args] loads a generator from a\n\
+     shared object (see dieharder/dh_plugin.h) and tests it in-process.\n\
   -h prints context-sensitive help -- usually Usage (this message) or a\n\
      test synopsis if entered as e.g. dieharder -D 3 -h.\n\
+  -H half - low, high or both (the default):  test only the low or only\n\
+     the high 32 bits of every 64 bit word of the generator (or of the\n\
+     input, with stdin_input_raw64 or file_input_raw64).  Generators\n\
+     that make 32 bits are read as pairs, the first in the low half.\n\
+  -j jobs - run the tests of a -a run on jobs threads.  Every test gets\n\
+     its own copy of the generator, seeded from the run seed, so the\n\
+     results depend on -S but not on the number of jobs (they are NOT\n\
+     the same as a serial -a run).  Output is in the usual order.\n\
+     Generators that read files or pipes are always run serially.\n\
+     With a single test (-d) the psamples are spread over the threads\n\
+     instead, each psample seeded from -S and its own index.\n\
   -k ks_flag - ks_flag\n\
 \n\
      0 is fast but slightly sloppy for psamples > 4999 (default).\n\
@@ -40,6 +40,7 @@ void output(Dtest *dtest,Test **test)
   * Show the table header at most one time.
   */
  static unsigned int firstcall = 1;
+ gsl_rng *frng;                 /* rng, or the rng -H wraps */
  if(firstcall){
 
    /*
@@ -80,16 +81,17 @@ void output(Dtest *dtest,Test **test)
   * possibly with additional conditionals rejecting test results involving
   * rewinds, period.
   */
- if(strncmp("file_input",gsl_rng_name(rng),10) == 0){
+ frng = dh_rng_half64_wrapped(rng) ? dh_rng_half64_wrapped(rng) : rng;
+ if(strncmp("file_input",gsl_rng_name(frng),10) == 0){
    /*
     * This needs its own output flag and field.  I'm losing it for now.
    if(!quiet){
-     fprintf(stdout,"# %u rands were used in this test\n",file_input_get_rtot(rng));
+     fprintf(stdout,"# %u rands were used in this test\n",file_input_get_rtot(frng));
      fflush(stdout);
    }
     */
-   if(file_input_get_rewind_cnt(rng) != 0){
-     fprintf(stderr,"# The file %s was rewound %u times\n",gsl_rng_name(rng),file_input_get_rewind_cnt(rng));
+   if(file_input_get_rewind_cnt(frng) != 0){
+     fprintf(stderr,"# The file %s was rewound %u times\n",gsl_rng_name(frng),file_input_get_rewind_cnt(frng));
      fflush(stderr);
    }
  }
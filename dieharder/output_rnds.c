@@ -18,7 +18,8 @@
 void output_rnds()
 {
 
- unsigned int i,j;
+ unsigned int i,j,k,n;
+ unsigned int buf[DH_FILL_BLOCK];
  double d;
  FILE *fp;
 
@@ -82,15 +83,17 @@ void output_rnds()
       * hand.
       */
      if(tsamples > 0){
-       for(i=0;i<tsamples;i++){
-         j = gsl_rng_get(rng);
-         fwrite(&j,sizeof(unsigned int),1,fp);
+       for(i=0;i<tsamples;i+=n){
+         n = tsamples - i;
+         if(n > DH_FILL_BLOCK) n = DH_FILL_BLOCK;
+         dh_rng_fill(rng,buf,n);
+         fwrite(buf,sizeof(unsigned int),n,fp);
          /*
           * Printing to stderr lets me read it and pass the binaries on through
           * to stdout and a pipe.
           */
          if(verbose) {
-           fprintf(stderr,"%10u\n",j);
+           for(k=0;k<n;k++) fprintf(stderr,"%10u\n",buf[k]);
          }
        }
      } else {
@@ -102,14 +105,14 @@ void output_rnds()
         * dieharder dies).
         */
        while(1){
-         j = gsl_rng_get(rng);
-         fwrite(&j,sizeof(unsigned int),1,fp);
+         dh_rng_fill(rng,buf,DH_FILL_BLOCK);
+         fwrite(buf,sizeof(unsigned int),DH_FILL_BLOCK,fp);
          /*
           * Printing to stderr lets me read it and pass the binaries on through
           * to stdout and a pipe.
           */
          if(verbose) {
-           fprintf(stderr,"%10u\n",j);
+           for(k=0;k<DH_FILL_BLOCK;k++) fprintf(stderr,"%10u\n",buf[k]);
          }
        }
      }
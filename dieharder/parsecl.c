@@ -53,7 +53,7 @@ void parsecl(int argc, char **argv)
     exit(1); /* count this as an error */
  }
 
- while ((c = getopt(argc,argv,"aBc:D:d:Ff:g:hi:k:lL:m:n:oO:p:P:S:s:t:Vv:W:X:x:Y:y:Z:z:")) != EOF){
+ while ((c = getopt(argc,argv,"aBc:D:d:Ff:g:hH:i:j:k:lL:m:n:oO:p:P:S:s:t:Vv:W:X:x:Y:y:Z:z:")) != EOF){
    switch (c){
      case 'a':
        all = YES;
@@ -162,9 +162,25 @@ void parsecl(int argc, char **argv)
      case 'h':
        help_flag = YES;
        break;
+     case 'H':
+       if(strncmp(optarg,"low",3) == 0){
+         half64 = DH_HALF64_LOW;
+       } else if(strncmp(optarg,"high",4) == 0){
+         half64 = DH_HALF64_HIGH;
+       } else if(strncmp(optarg,"both",4) == 0){
+         half64 = DH_HALF64_BOTH;
+       } else {
+         half64 = strtol(optarg,(char **) NULL,10);
+         if(half64 > DH_HALF64_HIGH) half64 = DH_HALF64_BOTH;
+       }
+       break;
      case 'i':
        iterations = strtol(optarg,(char **) NULL,10);
        break;
+     case 'j':
+       jobs = strtol(optarg,(char **) NULL,10);
+       if((int) jobs < 1) jobs = 1;
+       break;
      case 'k':
        ks_test = strtol(optarg,(char **) NULL,10);
        break;
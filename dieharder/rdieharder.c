@@ -83,7 +83,7 @@ SEXP dieharder(SEXP genS, SEXP testS, SEXP seedS, SEXP psamplesS, SEXP verbS, SE
     /* Now do the work that dieharder.c does */
     startup();
     work();
-    gsl_rng_free(rng);
+    dh_rng_free(rng);
     reset_bit_buffers();
 
     /* And then bring our results back to R */
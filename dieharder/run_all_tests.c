@@ -16,6 +16,23 @@
 
 #include "dieharder.h"
 
+/*
+ * With -j jobs > 1 the tests are queued with add_job() and run by
+ * run_jobs() at the end instead of being executed as they are reached.
+ */
+static int parallel;
+
+static void queue_test(int dtest_num)
+{
+
+ if(parallel){
+   add_job(dtest_num);
+ } else {
+   execute_test(dtest_num);
+ }
+
+}
+
 void run_all_tests()
 {
 
@@ -30,12 +47,24 @@ void run_all_tests()
   * specific test.  Only certain tests are run over an ntuple range.
   */
 
+ /*
+  * A -j run needs its own instance of the generator for every test.
+  */
+ parallel = 0;
+ if(jobs > 1){
+   if(dh_rng_can_clone(rng)){
+     parallel = 1;
+   } else {
+     fprintf(stderr,"# run_all_tests(): Generator %s cannot be run in parallel, ignoring -j %u.\n",gsl_rng_name(rng),jobs);
+   }
+ }
+
  /*
   * No special ntuple tests in diehard
   */
  for(dtest_num=0;dtest_num<dh_num_diehard_tests;dtest_num++){
    if(dh_test_types[dtest_num]){
-     execute_test(dtest_num);
+     queue_test(dtest_num);
    }
  }
 
@@ -44,7 +73,7 @@ void run_all_tests()
   */
  for(dtest_num=100;dtest_num<100+dh_num_sts_tests;dtest_num++){
    if(dh_test_types[dtest_num]){
-     execute_test(dtest_num);
+     queue_test(dtest_num);
    }
  }
 
@@ -72,26 +101,17 @@ void run_all_tests()
 	    * We might need to check to be sure it is "doable", but probably
 	    * not...
             */
-           execute_test(dtest_num);
+           queue_test(dtest_num);
          } else {
            /*
-            * Default is to test 1 through 8 bits, which takes a while on my
-            * (quite fast) laptop but is a VERY thorough test of randomness
-            * out to byte level.
+            * Default is to test 1 through 12 bits, which is a VERY thorough
+            * test of randomness out to byte level and beyond.  Test 213,
+            * rgb_bitdist_all, does all twelve in a single pass, reporting
+            * a line per ntuple just as twelve runs of rgb_bitdist would.
             */
-           ntmin = 1;
-           ntmax = 12;
-           /* ntmax = 8; */
-           /* printf("Setting ntmin = %d ntmax = %d\n",ntmin,ntmax); */
-           for(ntuple = ntmin;ntuple <= ntmax;ntuple++){
-             execute_test(dtest_num);
+           if(dh_test_types[213]){
+             queue_test(213);
            }
-           /*
-            * This RESTORES ntuple = 0, which is the only way we could have
-            * gotten here in the first place!
-            */
-           ntuple = 0;
-
 	 }
        }
        break;
@@ -111,10 +131,10 @@ void run_all_tests()
            if(ntuple < 2 || ntuple > 5){
              ntsave = ntuple;
              ntuple = 5;  /* This is the hardest test anyway */
-             execute_test(dtest_num);
+             queue_test(dtest_num);
              ntuple = ntsave;
            } else {
-             execute_test(dtest_num);
+             queue_test(dtest_num);
            }
          } else {
            /*
@@ -125,7 +145,7 @@ void run_all_tests()
            ntmax = 5;
            /* printf("Setting ntmin = %d ntmax = %d\n",ntmin,ntmax); */
            for(ntuple = ntmin;ntuple <= ntmax;ntuple++){
-	     execute_test(dtest_num);
+	     queue_test(dtest_num);
 	   }
            /*
             * This RESTORES ntuple = 0, which is the only way we could have
@@ -153,10 +173,10 @@ void run_all_tests()
            if(ntuple < 2){
              ntsave = ntuple;
              ntuple = 5;  /* This is the default operm5 value */
-             execute_test(dtest_num);
+             queue_test(dtest_num);
              ntuple = ntsave;
            } else {
-             execute_test(dtest_num);
+             queue_test(dtest_num);
            }
          } else {
            /*
@@ -167,7 +187,7 @@ void run_all_tests()
            ntmax = 5;
            /* printf("Setting ntmin = %d ntmax = %d\n",ntmin,ntmax); */
            for(ntuple = ntmin;ntuple <= ntmax;ntuple++){
-	     execute_test(dtest_num);
+	     queue_test(dtest_num);
 	   }
            /*
             * This RESTORES ntuple = 0, which is the only way we could have
@@ -191,7 +211,7 @@ void run_all_tests()
            /*
             * If ntuple is set to be nonzero, just use that value in "all".
             */
-           execute_test(dtest_num);
+           queue_test(dtest_num);
          } else {
            /*
             * Do all lags from 0 to 32.
@@ -200,7 +220,7 @@ void run_all_tests()
            ntmax = 32;
            /* printf("Setting ntmin = %d ntmax = %d\n",ntmin,ntmax); */
            for(ntuple = ntmin;ntuple <= ntmax;ntuple++){
-	     execute_test(dtest_num);
+	     queue_test(dtest_num);
 	   }
            /*
             * This RESTORES ntuple = 0, which is the only way we could have
@@ -219,7 +239,7 @@ void run_all_tests()
      case 204:
 
        if(dh_test_types[dtest_num]){
-         execute_test(dtest_num);
+         queue_test(dtest_num);
        }
        break;
 
@@ -229,7 +249,7 @@ void run_all_tests()
      case 205:
 
        if(dh_test_types[dtest_num]){
-         execute_test(dtest_num);
+         queue_test(dtest_num);
        }
        break;
 
@@ -239,14 +259,28 @@ void run_all_tests()
      case 206:
 
        if(dh_test_types[dtest_num]){
-         execute_test(dtest_num);
+         queue_test(dtest_num);
        }
        break;
 
+     /*
+      * Test 212 is rgb_binary_rank.  At its default 1024x1024 it takes
+      * minutes, so it is not part of -a; run it with -d rgb_binary_rank.
+      */
+     case 212:
+       break;
+
+     /*
+      * Test 213 is rgb_bitdist_all, which is run in place of test 200
+      * (above) when there is no ntuple.
+      */
+     case 213:
+       break;
+
      default:
        printf("Preparing to run test %d.  ntuple = %d\n",dtest_num,ntuple);
        if(dh_test_types[dtest_num]){   /* This is the fallback to normal tests */
-         execute_test(dtest_num);
+         queue_test(dtest_num);
        }
        break;
 
@@ -258,10 +292,12 @@ void run_all_tests()
   * Future expansion in -a tests...
  for(dtest_num=600;dtest_num<600+dh_num_user_tests;dtest_num++){
    if(dh_test_types[dtest_num]){
-     execute_test(dtest_num);
+     queue_test(dtest_num);
    }
  }
   */
 
+ if(parallel) run_jobs();
+
 }
 
@@ -0,0 +1,326 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * This is the -j jobs worker pool used by run_all_tests().  Instead of
+ * running each (test,ntuple) combination of a -a run as soon as it is
+ * reached, run_all_tests() hands it to add_job(), which gives it its
+ * own instance of the selected generator (on the substream of the run
+ * seed numbered by the job's place in the -a sequence if the generator
+ * has substreams, see dh_rng_substream(), or else seeded with a seed
+ * derived from the two, see dh_seed_derive()), its own dh_context and
+ * its own Test vector.  run_jobs() then runs the jobs on up to jobs
+ * threads, longest first so that one long test started last doesn't
+ * leave everybody else waiting, and outputs the results in the same
+ * order a serial -a run would.
+ *
+ * Note that the results of a -j run are NOT the same as those of a
+ * serial -a run, as every test now runs on its own stream.  They DO
+ * depend only on the seed and not on the number of threads, so
+ * dieharder -a -S 1 -j 2 and dieharder -a -S 1 -j 16 produce the same
+ * table.  With -s 1 every job is seeded from -S (or a fresh random
+ * seed) exactly as execute_test() would seed it.
+ *========================================================================
+ */
+
+#include "dieharder.h"
+#include <pthread.h>
+
+typedef struct {
+  int dtest_num;              /* Test to be run */
+  unsigned long int seed;     /* Seed of this job's generator */
+  double cost;                /* Estimated relative run time */
+  gsl_rng *rng;               /* This job's instance of the generator */
+  dh_context *ctx;            /* ...and its context */
+  Test **test;                /* The results */
+  /*
+   * Under -Y Xtrategy a test is output once per std_test() pass.  We
+   * save ks_pvalue (nkps per pass) and psamples for each pass so that
+   * the passes can be replayed through output() in order.
+   */
+  unsigned int npass;
+  double *ks_pvalues;
+  unsigned int *psamples;
+  int done;
+} Job;
+
+static Job *joblist = 0;
+static unsigned int njobs = 0;
+static unsigned int maxjobs = 0;
+static unsigned int *jobqueue = 0;    /* job indices, longest first */
+static unsigned int nextjob = 0;      /* next entry of jobqueue to run */
+static pthread_mutex_t job_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t job_done = PTHREAD_COND_INITIALIZER;
+
+/*
+ * Approximate run time of each test at its default tsamples and
+ * psamples, in seconds for mt19937 on a modest desktop (timed one
+ * psample at a time).  It only has to be good enough to get the order
+ * right.  Tests not in the table cost 1.
+ */
+static struct {
+  int dtest_num;
+  double cost;
+} job_costs[] = {
+  {  0,   3.0},   /* diehard_birthdays */
+  {  1,  15.0},   /* diehard_operm5 */
+  {  2,  18.0},   /* diehard_rank_32x32 */
+  {  3,   4.5},   /* diehard_rank_6x8 */
+  {  4,   5.0},   /* diehard_bitstream */
+  {  5,   6.0},   /* diehard_opso */
+  {  6,   5.0},   /* diehard_oqso */
+  {  7,  17.0},   /* diehard_dna */
+  {  8,   0.5},   /* diehard_count_1s_str */
+  {  9,   5.0},   /* diehard_count_1s_byt */
+  { 10,   1.8},   /* diehard_parking_lot */
+  { 11,   0.5},   /* diehard_2dsphere */
+  { 12,   2.0},   /* diehard_3dsphere */
+  { 13,  11.0},   /* diehard_squeeze */
+  { 14,   0.2},   /* diehard_sums */
+  { 15,   0.5},   /* diehard_runs */
+  { 16,   6.0},   /* diehard_craps */
+  { 17, 310.0},   /* marsaglia_tsang_gcd */
+  {100,   0.5},   /* sts_monobit */
+  {101,  18.0},   /* sts_runs */
+  {102,  32.0},   /* sts_serial */
+  {200,   8.0},   /* rgb_bitdist */
+  {201,  19.0},   /* rgb_minimum_distance */
+  {202,   5.0},   /* rgb_permutations */
+  {203,   3.0},   /* rgb_lagged_sums, per unit of lag */
+  {204,  11.0},   /* rgb_kstest_test */
+  {205,   5.5},   /* dab_bytedistrib */
+  {206,   5.0},   /* dab_dct */
+  {207,   7.0},   /* dab_filltree */
+  {208,  10.0},   /* dab_filltree2 */
+  {209,  11.0},   /* dab_monobit2 */
+  {212, 160.0},   /* rgb_binary_rank, at 1024x1024 */
+  {213,  36.0},   /* rgb_bitdist_all, ntuples 1-12 */
+  { -1,   1.0}
+};
+
+static double job_cost(int dtest_num,unsigned int nt)
+{
+
+ int i;
+ double cost = 1.0;
+
+ for(i=0;job_costs[i].dtest_num >= 0;i++){
+   if(job_costs[i].dtest_num == dtest_num){
+     cost = job_costs[i].cost;
+     break;
+   }
+ }
+ /*
+  * rgb_lagged_sums skips ntuple rands between samples, so its run time
+  * grows linearly with the lag.
+  */
+ if(dtest_num == 203) cost *= (double)(nt + 1);
+
+ /*
+  * rgb_binary_rank is cubic in its matrix size.
+  */
+ if(dtest_num == 212 && nt >= 32) cost *= pow((double) nt/1024.0,3.0);
+
+ /*
+  * ...and diehard_parking_lot quadratic in the side of its lot.
+  */
+ if(dtest_num == 10 && nt > 100) cost *= ((double) nt/100.0)*((double) nt/100.0);
+
+ return(cost);
+
+}
+
+/*
+ * Queue dtest_num to be run with the current value of ntuple (and all
+ * the other globals).  Everything the job needs is allocated here, in
+ * the main thread, so that the workers never touch the globals.
+ */
+void add_job(int dtest_num)
+{
+
+ Job *job;
+
+ if(njobs == maxjobs){
+   maxjobs = maxjobs ? 2*maxjobs : 64;
+   joblist = (Job *)realloc(joblist,maxjobs*sizeof(Job));
+   if(joblist == 0){
+     fprintf(stderr,"Error: add_job() cannot allocate the job list.\n");
+     Exit(1);
+   }
+ }
+ job = &joblist[njobs];
+ memset(job,0,sizeof(Job));
+ job->dtest_num = dtest_num;
+ job->cost = job_cost(dtest_num,ntuple);
+
+ /*
+  * See execute_test() for the -s strategy.
+  */
+ if(strategy){
+   if(Seed == 0){
+     job->seed = random_seed();
+   } else {
+     job->seed = Seed;
+   }
+ } else {
+   job->seed = dh_seed_derive(seed,njobs);
+ }
+ MYDEBUG(D_SEED){
+   fprintf(stdout,"# add_job(): job %u is test %d, ntuple %u, seed %lu\n",njobs,dtest_num,ntuple,job->seed);
+ }
+
+ job->rng = gsl_rng_alloc(rng->type);
+ if(strategy || !dh_rng_substream(job->rng,seed,njobs)){
+   gsl_rng_set(job->rng,job->seed);
+ }
+ job->ctx = dh_context_alloc(job->rng);
+ /*
+  * The jobs already keep every thread busy, so the psamples of each
+  * job are run serially.
+  */
+ job->ctx->seed = job->seed;
+ job->ctx->jobs = 1;
+ njobs++;
+
+}
+
+static void run_job(Job *job)
+{
+
+ Dtest *dtest = dh_test_types[job->dtest_num];
+ unsigned int need_more_p;
+ int i;
+
+ job->test = create_test_ctx(job->ctx,dtest,job->ctx->tsamples,job->ctx->psamples);
+ need_more_p = YES;
+ while(need_more_p){
+   std_test(dtest,job->test);
+   job->ks_pvalues = (double *)realloc(job->ks_pvalues,(job->npass+1)*dtest->nkps*sizeof(double));
+   job->psamples = (unsigned int *)realloc(job->psamples,(job->npass+1)*sizeof(unsigned int));
+   for(i=0;i<dtest->nkps;i++){
+     job->ks_pvalues[job->npass*dtest->nkps + i] = job->test[i]->ks_pvalue;
+   }
+   job->psamples[job->npass] = job->test[0]->psamples;
+   job->npass++;
+   need_more_p = need_more_psamples(dtest,job->test);
+ }
+
+}
+
+static void *job_worker(void *arg)
+{
+
+ Job *job;
+
+ while(1){
+   pthread_mutex_lock(&job_mutex);
+   if(nextjob >= njobs){
+     pthread_mutex_unlock(&job_mutex);
+     break;
+   }
+   job = &joblist[jobqueue[nextjob++]];
+   pthread_mutex_unlock(&job_mutex);
+
+   run_job(job);
+
+   pthread_mutex_lock(&job_mutex);
+   job->done = 1;
+   pthread_cond_broadcast(&job_done);
+   pthread_mutex_unlock(&job_mutex);
+ }
+
+ return(0);
+
+}
+
+/*
+ * Sort the queue by decreasing cost, keeping -a order among equals.
+ */
+static int compare_jobs(const void *a,const void *b)
+{
+
+ const Job *ja = &joblist[*(const unsigned int *)a];
+ const Job *jb = &joblist[*(const unsigned int *)b];
+
+ if(ja->cost > jb->cost) return(-1);
+ if(ja->cost < jb->cost) return(1);
+ if(*(const unsigned int *)a < *(const unsigned int *)b) return(-1);
+ if(*(const unsigned int *)a > *(const unsigned int *)b) return(1);
+ return(0);
+
+}
+
+/*
+ * Run all the queued jobs on (up to) jobs threads and output them in
+ * the order in which they were queued.
+ */
+void run_jobs()
+{
+
+ unsigned int i,j,k,nthreads;
+ unsigned long int seed_save;
+ pthread_t *threads;
+ Dtest *dtest;
+ Job *job;
+
+ if(njobs == 0) return;
+
+ jobqueue = (unsigned int *)malloc(njobs*sizeof(unsigned int));
+ for(i=0;i<njobs;i++) jobqueue[i] = i;
+ qsort(jobqueue,njobs,sizeof(unsigned int),compare_jobs);
+ nextjob = 0;
+
+ nthreads = jobs < njobs ? jobs : njobs;
+ threads = (pthread_t *)malloc(nthreads*sizeof(pthread_t));
+ for(i=0;i<nthreads;i++){
+   if(pthread_create(&threads[i],NULL,job_worker,NULL) != 0){
+     fprintf(stderr,"Error: run_jobs() cannot create thread %u.\n",i);
+     Exit(1);
+   }
+ }
+
+ /*
+  * Output every job as soon as it and all of its predecessors are done.
+  * Under -s strategy execute_test() shows the seed of every test, so
+  * we show the job's seed; otherwise the run seed, from which the job
+  * seeds are derived, is the one to report.
+  */
+ seed_save = seed;
+ for(i=0;i<njobs;i++){
+   job = &joblist[i];
+   pthread_mutex_lock(&job_mutex);
+   while(!job->done) pthread_cond_wait(&job_done,&job_mutex);
+   pthread_mutex_unlock(&job_mutex);
+
+   dtest = dh_test_types[job->dtest_num];
+   if(strategy) seed = job->seed;
+   for(j=0;j<job->npass;j++){
+     for(k=0;k<dtest->nkps;k++){
+       job->test[k]->ks_pvalue = job->ks_pvalues[j*dtest->nkps + k];
+       job->test[k]->psamples = job->psamples[j];
+     }
+     output(dtest,job->test);
+   }
+
+   destroy_test(dtest,job->test);
+   dh_context_free(job->ctx);
+   dh_rng_free(job->rng);
+   nullfree(job->ks_pvalues);
+   nullfree(job->psamples);
+ }
+ seed = seed_save;
+
+ for(i=0;i<nthreads;i++){
+   pthread_join(threads[i],NULL);
+ }
+ free(threads);
+ nullfree(jobqueue);
+ nullfree(joblist);
+ njobs = 0;
+ maxjobs = 0;
+
+}
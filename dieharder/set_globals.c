@@ -25,8 +25,10 @@ void set_globals()
  generator_name[0] = (char)0; /* empty generator name is default */
  gvcount = 0;           /* Count of generators so far */
  gscount = 0;           /* Count of seeds so far */
+ half64 = DH_HALF64_BOTH; /* Test both halves of 64 bit words */
  help_flag = NO;        /* No help requested */
  iterations = -1;	/* For timing loop, set iterations to be timed */
+ jobs = 1;              /* Run -a tests serially, one thread */
  list = NO;             /* List all generators */
  ntuple = 0;            /* n-tuple size for n-tuple tests (0 means all) */
  overlap = 1;           /* Default is to use overlapping samples in tests that support a choice */
@@ -0,0 +1,110 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * The streaming bit reader that replaces get_rand_bits_uint().  The
+ * generator's output is treated as one long bitstream made of the
+ * rmax_bits valid bits of each return, most significant bit first, and
+ * dh_bits_get(ctx,nbits) returns the next nbits (1-32) of it, right
+ * justified -- precisely the bits get_rand_bits_uint() returned, so
+ * results are unchanged.  Unread bits wait in a 64 bit accumulator, so
+ * a request never has to stitch two partial buffers together, and a
+ * request of exactly rmax_bits just passes the next word through (as
+ * get_rand_bits_uint() always did) without disturbing the accumulator.
+ *
+ * Words are fetched from the generator only as they are needed, one at
+ * a time, because whatever the reader fetched and didn't use would be
+ * missing from the stream of the next consumer (e.g. the next test of a
+ * -a run).  A test that knows how many bits it will read can promise
+ * them with dh_bits_reserve(), after which the words are fetched through
+ * dh_rng_fill() a block at a time.
+ *========================================================================
+ */
+
+/*
+ * The next word of the generator's stream.
+ */
+static inline unsigned int dh_bits_word(dh_context *ctx)
+{
+
+ dh_bitstate *b = &ctx->bits;
+
+ if(b->wpos == b->wlen){
+   if(b->budget == 0) return((unsigned int) gsl_rng_get(ctx->rng));
+   dh_bits_refill(ctx);
+ }
+ return(b->wbuf[b->wpos++]);
+
+}
+
+static inline unsigned int dh_bits_get(dh_context *ctx,unsigned int nbits)
+{
+
+ dh_bitstate *b = &ctx->bits;
+ unsigned int rmax_bits = ctx->rmax_bits;
+
+ if(nbits == rmax_bits) return(dh_bits_word(ctx));
+
+ while(b->nacc < nbits){
+   b->acc = (b->acc << rmax_bits) | (dh_bits_word(ctx) & ctx->rmax_mask);
+   b->nacc += rmax_bits;
+ }
+ b->nacc -= nbits;
+ return((unsigned int)(b->acc >> b->nacc) & (0xffffffffu >> (32 - nbits)));
+
+}
+
+/*
+ * Fast paths for the common request sizes.  A request the accumulator
+ * can already satisfy is shifted straight out of it (unless it is a
+ * whole word, which dh_bits_get() passes through untouched), and a 32
+ * bit request of a 32 bit generator is simply the next word.  Anything
+ * else goes the long way round, so the bits are the same either way.
+ */
+static inline unsigned int dh_bits_take(dh_context *ctx,unsigned int nbits)
+{
+
+ dh_bitstate *b = &ctx->bits;
+
+ if(b->nacc >= nbits && nbits != ctx->rmax_bits){
+   b->nacc -= nbits;
+   return((unsigned int)(b->acc >> b->nacc) & ((1u << nbits) - 1));
+ }
+ return(dh_bits_get(ctx,nbits));
+
+}
+
+static inline unsigned int dh_bits_get1(dh_context *ctx)
+{
+ return(dh_bits_take(ctx,1));
+}
+
+static inline unsigned int dh_bits_get2(dh_context *ctx)
+{
+ return(dh_bits_take(ctx,2));
+}
+
+static inline unsigned int dh_bits_get4(dh_context *ctx)
+{
+ return(dh_bits_take(ctx,4));
+}
+
+static inline unsigned int dh_bits_get8(dh_context *ctx)
+{
+ return(dh_bits_take(ctx,8));
+}
+
+static inline unsigned int dh_bits_get16(dh_context *ctx)
+{
+ return(dh_bits_take(ctx,16));
+}
+
+static inline unsigned int dh_bits_get32(dh_context *ctx)
+{
+ if(ctx->rmax_bits == 32) return(dh_bits_word(ctx));
+ return(dh_bits_get(ctx,32));
+}
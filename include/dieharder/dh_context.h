@@ -0,0 +1,115 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * dh_context is the per-run state of a test.  Historically every test
+ * pulled its generator, its run parameters and (through bits.c and
+ * static_get_bits.c) its bit-extraction buffers out of process-wide
+ * globals, which made it impossible to run two tests at the same time
+ * in one process.  A context carries all of that instead, and is handed
+ * to the test through the Test struct (test[0]->ctx) by create_test_ctx().
+ *
+ * The old global interface still works.  dh_global_context() returns a
+ * context that simply mirrors the globals in libdieharder.h, and
+ * create_test(), get_uint_rand(), get_rand_bits() and reset_bit_buffers()
+ * all use it, so a UI that never heard of contexts behaves exactly as
+ * it always did.
+ *========================================================================
+ */
+
+/*
+ * Size (in uints) of the streaming buffer used by get_rand_bits(), and
+ * how many whole uints it keeps ahead of the bit being read.
+ */
+#define DH_RBITS_BUF 512
+#define DH_RBITS_AHEAD 5
+
+/*
+ * Size (in uints) of the block that dh_bits_reserve() lets the bit
+ * reader fetch at a time.
+ */
+#define DH_BITS_WBUF 256
+
+ /*
+  * The bit-extraction state formerly kept in static variables in bits.c
+  * and static_get_bits.c.  dh_context_reset_bits() returns it to the
+  * "first call" state.
+  */
+ typedef struct {
+   /* get_uint_rand() and dh_uint_fill() */
+   uint64_t uacc;               /* Leftover bits of the last return, lowest next */
+   unsigned int unacc;          /* Number of bits in uacc */
+   unsigned int ulast;          /* The last uint returned */
+   unsigned int ucarry;         /* ulast ended exactly at the end of a return */
+   unsigned int ufirst;         /* Nonzero until the first call */
+   /* get_rand_bits() */
+   unsigned int rbuf[DH_RBITS_BUF];  /* Stream uints, lsb of rbuf[0] first */
+   unsigned int rlen;           /* Number of uints in rbuf */
+   unsigned int rbit;           /* Next unread bit of rbuf */
+   off_t rbase;                 /* Uints dropped from the front of rbuf so far */
+   off_t rlimit;                /* Uints dh_rand_bits_reserve() lets us fetch */
+   /* dh_bits_get() (see dh_bits.h) */
+   uint64_t acc;                /* Bit accumulator, oldest bit leftmost */
+   unsigned int nacc;           /* Number of unread bits in acc */
+   unsigned int wbuf[DH_BITS_WBUF];  /* Words fetched ahead by dh_bits_reserve() */
+   unsigned int wpos;           /* Next word of wbuf to use */
+   unsigned int wlen;           /* Number of words in wbuf */
+   off_t budget;                /* Words promised by dh_bits_reserve() not yet fetched */
+ } dh_bitstate;
+
+ typedef struct {
+   /* The generator and what we know about its output */
+   gsl_rng *rng;
+   unsigned int random_max;
+   unsigned int rmax_bits;      /* Number of valid bits in rng */
+   unsigned int rmax_mask;      /* Mask for valid section of unsigned int */
+   unsigned long int seed;      /* Seed of the run (see dh_seed_derive()) */
+
+   /* Run parameters (see the globals of the same name) */
+   unsigned int all;
+   unsigned int ks_test;
+   double multiply_p;
+   unsigned int ntuple;
+   unsigned int overlap;
+   unsigned int psamples;
+   off_t tsamples;
+   unsigned int Xtrategy;
+   unsigned int Xstep;
+   unsigned int Xoff;
+   double x_user;
+   double y_user;
+   double z_user;
+   unsigned int jobs;           /* Threads to spread psamples over */
+
+   /* Bit extraction state */
+   dh_bitstate bits;
+
+   /* Scratch workspace, grown on demand by dh_context_workspace() */
+   void *work;
+   size_t work_size;
+
+   /* Nonzero for the shim context returned by dh_global_context() */
+   unsigned int global;
+ } dh_context;
+
+ dh_context *dh_context_alloc(gsl_rng *rng);
+ void dh_context_free(dh_context *ctx);
+ void dh_context_set_rng(dh_context *ctx,gsl_rng *rng);
+ void dh_context_load_globals(dh_context *ctx);
+ void dh_context_reset_bits(dh_context *ctx);
+ void *dh_context_workspace(dh_context *ctx,size_t size);
+ dh_context *dh_global_context();
+ int dh_rng_can_clone(gsl_rng *rng);
+ dh_context *dh_context_clone(dh_context *parent,gsl_rng *rng);
+ unsigned long int dh_seed_derive(unsigned long int base,unsigned long int index);
+
+ unsigned int get_uint_rand_ctx(dh_context *ctx);
+ void dh_uint_fill(dh_context *ctx,unsigned int *out,size_t n);
+ void dh_bits_reserve(dh_context *ctx,off_t nbits);
+ void dh_bits_refill(dh_context *ctx);
+ void dh_rand_bits_reserve(dh_context *ctx,off_t nbits);
+ void get_rand_bits_ctx(void *result,unsigned int rsize,unsigned int nbits,dh_context *ctx);
@@ -0,0 +1,62 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * The generator plugin ABI.  A plugin is a shared object that exports
+ *
+ *   const dh_plugin *dh_plugin_entry(void);
+ *
+ * returning a (static) dh_plugin that describes one generator.  It is
+ * loaded with
+ *
+ *   dieharder -g plugin:/path/to/libmyrng.so[:args] ...
+ *
+ * and from then on is an ordinary generator (in the 700-999 range) that
+ * runs in-process and fills the tests' buffers directly.  create() is
+ * called once per instance, with the args string (or "") -- and there is
+ * one instance per thread under -j, so instances must not share state.
+ * This header needs nothing else from dieharder and may be copied into
+ * the plugin's own sources.
+ *
+ * Later versions of the ABI only ever add members at the end, and bump
+ * DH_PLUGIN_ABI; dieharder loads any plugin whose abi is between 1 and
+ * its own DH_PLUGIN_ABI.
+ *========================================================================
+ */
+
+#ifndef DH_PLUGIN_H
+#define DH_PLUGIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DH_PLUGIN_ABI 1
+#define DH_PLUGIN_ENTRY "dh_plugin_entry"
+
+typedef struct {
+  uint32_t abi;                 /* DH_PLUGIN_ABI the plugin was built with */
+  const char *name;             /* Generator name, as listed by -g -1 */
+
+  /* A new instance, or NULL on failure (bad args and such) */
+  void *(*create)(const char *args);
+  /* (Re)seed an instance.  Same seed, same stream. */
+  void (*seed)(void *g,uint64_t seed);
+  /* The next n 32 bit outputs */
+  void (*fill_u32)(void *g,uint32_t *buf,size_t n);
+  /* The next n 64 bit outputs, or NULL if the generator isn't 64 bit */
+  void (*fill_u64)(void *g,uint64_t *buf,size_t n);
+  void (*destroy)(void *g);
+  /*
+   * Optional:  move a freshly seeded instance to the start of its k'th
+   * non-overlapping substream (see dh_rng_substream()), or NULL.
+   */
+  void (*jump)(void *g,uint64_t k);
+} dh_plugin;
+
+typedef const dh_plugin *(*dh_plugin_entry_t)(void);
+
+#endif /* DH_PLUGIN_H */
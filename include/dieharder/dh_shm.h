@@ -0,0 +1,93 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * The shared memory ring read by the shm_input generator, and the
+ * producer side of it.  A producer process creates a named POSIX shared
+ * memory segment (shm_open()) holding a dh_shm_header followed, at
+ * header_size bytes from the start, by a ring of size bytes, and
+ * streams its random bytes through it; dieharder attaches with
+ *
+ *   dieharder -g shm_input -f /name ...
+ *
+ * and reads the words straight out of the ring.  There is exactly one
+ * producer and one consumer.
+ *
+ * head and tail count the bytes ever written and ever consumed, so the
+ * ring holds head - tail bytes, starting at data[tail % size], and has
+ * room for size - (head - tail) more.  The producer writes data and only
+ * then moves head (a release store), and the consumer reads data and
+ * only then moves tail, so neither ever looks at bytes the other owns.
+ * Whoever moves head (tail) also bumps data_seq (space_seq) and, if the
+ * other side says it is waiting, wakes it with FUTEX_WAKE on that word;
+ * the waiting side sets its waiting flag and FUTEX_WAITs on the seq it
+ * read before it last looked at head (tail), so no wakeup is lost.  eof
+ * is set (and data_seq bumped) when the producer is done, and detached
+ * (and space_seq bumped) when the consumer exits.
+ *
+ * The producer routines below are in libdieharder, but dh_shm_producer.c
+ * needs nothing but this header and may be built into the producer
+ * instead (cc -c dh_shm_producer.c, plus -lrt on older systems).
+ *========================================================================
+ */
+
+#ifndef DH_SHM_H
+#define DH_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DH_SHM_MAGIC 0x6d687364U        /* "dshm" */
+#define DH_SHM_VERSION 1
+#define DH_SHM_HEADER 4096              /* header_size:  the data is page aligned */
+#define DH_SHM_SIZE (1 << 24)           /* Default ring size (16 MB) */
+
+typedef struct {
+  /* Set once by the producer; magic is set last */
+  uint32_t magic;               /* DH_SHM_MAGIC */
+  uint32_t version;             /* DH_SHM_VERSION */
+  uint32_t word_size;           /* 4 or 8:  the producer's word size */
+  uint32_t header_size;         /* Bytes from the segment to the data */
+  uint64_t size;                /* Bytes of data, a power of 2 >= 4096 */
+  uint8_t pad0[40];
+  /* Written by the producer */
+  uint64_t head;                /* Bytes ever written */
+  uint32_t data_seq;            /* futex:  bumped when head moves or eof is set */
+  uint32_t eof;                 /* Nonzero once the producer is done */
+  uint32_t producer_waiting;    /* Nonzero while the producer waits for room */
+  uint8_t pad1[44];
+  /* Written by the consumer */
+  uint64_t tail;                /* Bytes ever consumed */
+  uint32_t space_seq;           /* futex:  bumped when tail moves */
+  uint32_t consumer_waiting;    /* Nonzero while the consumer waits for data */
+  uint32_t detached;            /* Nonzero once the consumer is gone */
+  uint8_t pad2[44];
+} dh_shm_header;
+
+/*
+ * The producer.  dh_shm_producer_create() makes (or remakes) the segment
+ * name with a ring of size bytes (0 for DH_SHM_SIZE, else rounded up to
+ * a power of 2) and returns NULL, with errno set, if it cannot.
+ * dh_shm_producer_write() copies n bytes in, waiting for room as it
+ * goes.  dh_shm_producer_reserve() instead returns where up to *n bytes
+ * can be written in place (*n is cut to what is free and contiguous,
+ * after waiting for at least one byte of room) and
+ * dh_shm_producer_commit() publishes the first n of them.  Once the
+ * consumer has exited, write returns -1 and reserve NULL, with errno
+ * EPIPE, rather than waiting for room that will never come.
+ * dh_shm_producer_close() sets eof, unmaps the ring and removes the
+ * name (a consumer that is attached reads on to the end).
+ */
+typedef struct dh_shm_producer dh_shm_producer;
+
+dh_shm_producer *dh_shm_producer_create(const char *name,size_t size,unsigned int word_size);
+int dh_shm_producer_write(dh_shm_producer *p,const void *buf,size_t n);
+void *dh_shm_producer_reserve(dh_shm_producer *p,size_t *n);
+void dh_shm_producer_commit(dh_shm_producer *p,size_t n);
+void dh_shm_producer_close(dh_shm_producer *p);
+
+#endif /* DH_SHM_H */
@@ -24,6 +24,9 @@ static Dtest diehard_parking_lot_dtest __attribute__((unused)) = {
 # to normally distributed.  Thus (k-3523)/21.9 is a standard\n\
 # normal variable, which converted to a uniform p-value, provides\n\
 # input to a KS test with a default 100 samples.\n\
+#\n\
+# -n 200, 400 or 800 parks instead on a lot of that side, with\n\
+# 1.2*side^2 attempts and the mean and sigma of k from simulation.\n\
 #==================================================================\n",
   100,
   0,
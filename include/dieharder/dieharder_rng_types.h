@@ -38,6 +38,9 @@
  GSL_VAR const gsl_rng_type *gsl_rng_dev_random;
  GSL_VAR const gsl_rng_type *gsl_rng_dev_arandom;
  GSL_VAR const gsl_rng_type *gsl_rng_dev_urandom;
+ GSL_VAR const gsl_rng_type *gsl_rng_getrandom;
+ GSL_VAR const gsl_rng_type *gsl_rng_getrandom_prefetch;
+ int getrandom_available(void);
 
  GSL_VAR const gsl_rng_type *gsl_rng_r_wichmann_hill;	/* edd May 2007 */
  GSL_VAR const gsl_rng_type *gsl_rng_r_marsaglia_mc;	/* edd May 2007 */
@@ -53,6 +56,15 @@
  GSL_VAR const gsl_rng_type *gsl_rng_kiss;	        /* rgb Jan 2011 */
  GSL_VAR const gsl_rng_type *gsl_rng_superkiss;	        /* rgb Jan 2011 */
  GSL_VAR const gsl_rng_type *gsl_rng_XOR;	        /* rgb Jan 2011 */
+ GSL_VAR const gsl_rng_type *gsl_rng_xoshiro256ss;
+ GSL_VAR const gsl_rng_type *gsl_rng_xoroshiro128p;
+ GSL_VAR const gsl_rng_type *gsl_rng_pcg64;
+ GSL_VAR const gsl_rng_type *gsl_rng_splitmix64;
+ GSL_VAR const gsl_rng_type *gsl_rng_philox4x32;
+ GSL_VAR const gsl_rng_type *gsl_rng_chacha20;
+ GSL_VAR const gsl_rng_type *gsl_rng_stdin_input_raw64;
+ GSL_VAR const gsl_rng_type *gsl_rng_file_input_raw64;
+ GSL_VAR const gsl_rng_type *gsl_rng_shm_input;
 
  /*
   * rng global vectors and variables for setup and tests.
@@ -80,3 +92,117 @@
 
  gsl_rng *rng;                  /* global gsl random number generator */
 
+ /*
+  * Bulk fill.  dh_rng_fill(rng,buf,n) puts the next n returns of
+  * gsl_rng_get(rng) (as uints) into buf, exactly as n calls would, but
+  * without a trip through the gsl_rng_type function pointer per word
+  * for generators that register a native fill routine.  Everything else
+  * gets the loop.  Tests that pull a known number of words in a row
+  * should pull them DH_FILL_BLOCK (or fewer) at a time, and never more
+  * than they use, or the next psample would see a different stream.
+  */
+#define DH_FILL_BLOCK 1024
+#define DH_MAXFILLS 64
+
+ typedef void (*dh_rng_fill_t)(void *vstate,unsigned int *buf,size_t n);
+
+ void dh_rng_fill(gsl_rng *rng,unsigned int *buf,size_t n);
+ void dh_rng_fill_register(const gsl_rng_type *type,dh_rng_fill_t fill);
+ dh_rng_fill_t dh_rng_fill_lookup(const gsl_rng_type *type);
+
+#define FILL(t,f) dh_rng_fill_register((t),(f));
+
+ /*
+  * 64 bit fill.  dh_rng_fill64(rng,buf,n) puts the next n 64 bit words of
+  * rng into buf (see rng_fill.c for what that means for generators that
+  * only make 32).
+  */
+ typedef void (*dh_rng_fill64_t)(void *vstate,uint64_t *buf,size_t n);
+
+ void dh_rng_fill64(gsl_rng *rng,uint64_t *buf,size_t n);
+ void dh_rng_fill64_register(const gsl_rng_type *type,dh_rng_fill64_t fill64);
+
+#define FILL64(t,f) dh_rng_fill64_register((t),(f));
+
+ /*
+  * The 32 bit stream the tests see of a 64 bit word stream (half64, -H):
+  * both halves (low first, as the 64 bit generators do by themselves),
+  * or only the low or only the high halves.  dh_rng_half64(type,half)
+  * returns a generator type that hands out the chosen halves of type's
+  * 64 bit words (or type itself, for DH_HALF64_BOTH).
+  */
+#define DH_HALF64_BOTH 0
+#define DH_HALF64_LOW 1
+#define DH_HALF64_HIGH 2
+
+ const gsl_rng_type *dh_rng_half64(const gsl_rng_type *type,unsigned int half);
+ const gsl_rng_type *dh_rng_half64_inner(const gsl_rng_type *type);
+ gsl_rng *dh_rng_half64_wrapped(gsl_rng *rng);
+
+ /*
+  * Substreams.  dh_rng_substream(rng,seed,k) seeds rng with seed and
+  * then puts it at the start of the k'th of a set of substreams that
+  * provably do not overlap, by jumping ahead or by setting a stream,
+  * counter or nonce word.  It is for parallel runs (one substream per
+  * worker or psample).  It returns 0 if rng's type has no substreams.
+  */
+ typedef void (*dh_rng_substream_t)(void *vstate,unsigned long int seed,unsigned long int k);
+
+ int dh_rng_substream(gsl_rng *rng,unsigned long int seed,unsigned long int k);
+ void dh_rng_substream_register(const gsl_rng_type *type,dh_rng_substream_t substream);
+
+#define SUBSTREAM(t,f) dh_rng_substream_register((t),(f));
+
+ /*
+  * Generators loaded from shared objects (see dh_plugin.h).  Instances
+  * of any generator can be freed with dh_rng_free(), but plugin,
+  * getrandom_prefetch and XOR instances must be, or the plugin's
+  * instance (or the prefetch threads, their buffers and XOR's
+  * component generators) leak.
+  */
+ int dh_rng_plugin_load(const char *spec);
+ void dh_rng_free(gsl_rng *rng);
+
+ /* Native fill routines of the dieharder generators */
+ void stdin_input_raw_fill(void *vstate,unsigned int *buf,size_t n);
+ void file_input_raw_fill(void *vstate,unsigned int *buf,size_t n);
+ void file_input_fill(void *vstate,unsigned int *buf,size_t n);
+ void ca_fill(void *vstate,unsigned int *buf,size_t n);
+ void uvag_fill(void *vstate,unsigned int *buf,size_t n);
+ void aes_fill(void *vstate,unsigned int *buf,size_t n);
+ void threefish_fill(void *vstate,unsigned int *buf,size_t n);
+ void threefish_fill64(void *vstate,uint64_t *buf,size_t n);
+ void kiss_fill(void *vstate,unsigned int *buf,size_t n);
+ void superkiss_fill(void *vstate,unsigned int *buf,size_t n);
+ void XOR_fill(void *vstate,unsigned int *buf,size_t n);
+ void XOR_free(void *vstate);
+ void xoshiro256ss_fill(void *vstate,unsigned int *buf,size_t n);
+ void xoroshiro128p_fill(void *vstate,unsigned int *buf,size_t n);
+ void pcg64_fill(void *vstate,unsigned int *buf,size_t n);
+ void splitmix64_fill(void *vstate,unsigned int *buf,size_t n);
+ void philox4x32_fill(void *vstate,unsigned int *buf,size_t n);
+ void chacha20_fill(void *vstate,unsigned int *buf,size_t n);
+ void getrandom_fill(void *vstate,unsigned int *buf,size_t n);
+ void getrandom_prefetch_fill(void *vstate,unsigned int *buf,size_t n);
+ void getrandom_prefetch_free(void *vstate);
+ void shm_input_fill(void *vstate,unsigned int *buf,size_t n);
+ void stdin_input_raw64_fill64(void *vstate,uint64_t *buf,size_t n);
+ void file_input_raw64_fill64(void *vstate,uint64_t *buf,size_t n);
+ void shm_input_fill64(void *vstate,uint64_t *buf,size_t n);
+ void xoshiro256ss_fill64(void *vstate,uint64_t *buf,size_t n);
+ void xoroshiro128p_fill64(void *vstate,uint64_t *buf,size_t n);
+ void pcg64_fill64(void *vstate,uint64_t *buf,size_t n);
+ void splitmix64_fill64(void *vstate,uint64_t *buf,size_t n);
+
+ /* Jumps and substreams (see the generators for the details) */
+ uint64_t splitmix64_next(uint64_t *x);
+ void xoshiro256ss_jump(void *vstate);
+ void xoshiro256ss_substream(void *vstate,unsigned long int seed,unsigned long int k);
+ void xoroshiro128p_jump(void *vstate);
+ void xoroshiro128p_substream(void *vstate,unsigned long int seed,unsigned long int k);
+ void pcg64_advance(void *vstate,uint64_t delta_hi,uint64_t delta_lo);
+ void pcg64_substream(void *vstate,unsigned long int seed,unsigned long int k);
+ void splitmix64_substream(void *vstate,unsigned long int seed,unsigned long int k);
+ void philox4x32_substream(void *vstate,unsigned long int seed,unsigned long int k);
+ void chacha20_substream(void *vstate,unsigned long int seed,unsigned long int k);
+
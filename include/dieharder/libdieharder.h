@@ -20,6 +20,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <stdint.h>
 
 /* This turns on M_PI in math.h */
 #define __USE_BSD 1
@@ -36,6 +37,8 @@
 #include <gsl/gsl_vector.h>
 #include <gsl/gsl_matrix.h>
 #include <gsl/gsl_eigen.h>
+#include <dieharder/dh_context.h>
+#include <dieharder/dh_bits.h>
 #include <dieharder/Dtest.h>
 #include <dieharder/parse.h>
 #include <dieharder/verbose.h>
@@ -139,6 +142,8 @@
  void add_lib_rngs();
 
  int binary_rank(unsigned int **mtx,int mrows,int ncols);
+ void binary_rank_batch(const unsigned int *mtx,int mrows,int ncols,int nmat,int *ranks);
+ int binary_rank64(uint64_t *mtx,int mrows,int ncols);
     
  /*
   *========================================================================
@@ -172,6 +177,7 @@
  unsigned int gnumbs[GVECMAX];       /* VECTOR of GSL generators to be XOR'd into a "super" generator */
  unsigned int gvcount;               /* Number of generators to be XOR'd into a "super" generator */
  unsigned int gscount;               /* Number of seeds entered on the CL in XOR mode */
+ unsigned int half64;           /* Halves of 64 bit words to test (DH_HALF64_*, -H) */
  unsigned int help_flag;        /* Help flag */
  unsigned int hist_flag;        /* Histogram display flag */
  unsigned int iterations;	/* For timing loop, set iterations to be timed */
@@ -197,6 +203,7 @@
  unsigned int Xtrategy;         /* Strategy used in TTD mode */
  unsigned int Xstep;            /* Number of additional psamples in TTD/RA mode */
  unsigned int Xoff;             /* Max number of psamples in TTD/RA mode */
+ unsigned int jobs;             /* Threads to use for -a tests or psamples (-j) */
  double x_user;         /* Reserved general purpose command line inputs for */
  double y_user;         /* use in any new user test. */
  double z_user;
@@ -230,11 +237,12 @@
 
  /*
   * Global variables and prototypes associated with file_input and
-  * file_input_raw.
+  * file_input_raw (and stdin_input_raw).
   */
  unsigned int file_input_get_rewind_cnt(gsl_rng *rng);
  off_t file_input_get_rtot(gsl_rng *rng);
  void file_input_set_rtot(gsl_rng *rng,unsigned int value);
+ void stdin_input_get_stalls(gsl_rng *rng,double *source_stall,double *test_stall);
 
  char filename[K];      /* Input file name */
  int fromfile;		/* set true if file is used for rands */
@@ -256,6 +264,10 @@
  *  rtot is a count of rands returned since the file was opened
  *  rewind_cnt is a count of how many times the file was rewound
  *     since its last open.
+ *  map is the file mapped into memory (file_input_raw only, NULL if
+ *     it is read through fp), and maplen the length of the mapping.
+ *  ibuf is the read buffer for the data lines (file_input only), ipos
+ *     the next unread char in it and ilen the number of chars in it.
  */
  typedef struct {
     FILE *fp;
@@ -263,6 +275,11 @@
     off_t rptr;
     off_t rtot;
     unsigned int rewind_cnt;
+    unsigned int *map;
+    size_t maplen;
+    char *ibuf;
+    size_t ipos;
+    size_t ilen;
   } file_input_state_t;
 
 
@@ -296,4 +313,19 @@
 typedef struct {
   double c[RGB_MINIMUM_DISTANCE_MAXDIM];
 } dTuple;
+
+/*
+ * The smallest squared distance between any two of n points in
+ * [0,side)^dim, coordinate d of point i being x[d][i] (see mindist.c).
+ */
+ double dh_mindist2(double *const *x,size_t n,unsigned int dim,double side);
+
+/*
+ * The 2^20 bit "missing words" bitset of diehard_opso, diehard_oqso and
+ * diehard_dna (see missing_words.c).
+ */
+#define DH_WORDS (1 << 20)
+#define DH_WORDS_SET(w,i) ((w)[(i) >> 6] |= (uint64_t) 1 << ((i) & 63))
+ uint64_t *dh_words_clear(dh_context *ctx);
+ uint dh_words_missing(const uint64_t *w);
  
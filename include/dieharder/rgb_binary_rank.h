@@ -0,0 +1,32 @@
+/*
+ * rgb_binary_rank test header.
+ */
+
+/*
+ * function prototype
+ */
+int rgb_binary_rank(Test **test,int irun);
+
+static Dtest rgb_binary_rank_dtest __attribute__((unused)) = {
+  "RGB Large Binary Rank Test",
+  "rgb_binary_rank",
+  "\n\
+#========================================================================\n\
+#                   RGB Large Binary Rank Test\n\
+# This is the binary rank test of diehard_rank_32x32 for big square\n\
+# matrices, by default 1024x1024 (-n sets the size, e.g. -n 4096).  Each\n\
+# row is filled with consecutive bits from the generator, the rank over\n\
+# {0,1} is found, and a chisq test is done on the counts of ranks n,\n\
+# n-1, n-2 and <= n-3 (whose probabilities barely depend on n).  A\n\
+# generator whose bits obey a linear recurrence over {0,1} with fewer\n\
+# state bits than the matrix has rows cannot make a full rank matrix,\n\
+# so large sizes fail generators that the small rank tests pass.\n\
+# It is not part of -a (at 1024x1024 it takes minutes); run it with\n\
+# -d rgb_binary_rank.\n\
+#\n",
+  100,     /* Default psamples */
+  200,     /* Default tsamples */
+  1,
+  rgb_binary_rank,
+  0
+};
@@ -21,9 +21,11 @@ static Dtest rgb_bitdist_dtest __attribute__((unused)) = {
 # are independent.  Every other sample is offset modulus of the\n\
 # sample index and ntuple_max.\n\
 #\n\
-# This test must be run with -n ntuple for ntuple > 0.  Note that if\n\
-# ntuple > 12, one should probably increase tsamples so that each of the\n\
-# 2^ntuple bins should end up with an average of around 30 occurrences.\n\
+# This test must be run with -n ntuple for ntuple > 0 (without -n, -a\n\
+# runs ntuple 1 through 12 in a single pass as rgb_bitdist_all, test\n\
+# 213).  Note that if ntuple > 12, one should probably increase\n\
+# tsamples so that each of the 2^ntuple bins should end up with an\n\
+# average of around 30 occurrences.\n\
 # Note also that the memory requirements and CPU time requirements will\n\
 # get quite large by e.g. ntuple = 20 -- use caution when sampling the\n\
 # distribution of very large ntuples.\n\
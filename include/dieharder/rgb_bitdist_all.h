@@ -0,0 +1,34 @@
+/*
+ * rgb_bitdist_all test header.
+ */
+
+/*
+ * The widest ntuple tested.
+ */
+#define RGB_BITDIST_NTMAX 12
+
+/*
+ * function prototype
+ */
+int rgb_bitdist_all(Test **test,int irun);
+
+static Dtest rgb_bitdist_all_dtest __attribute__((unused)) = {
+  "RGB Bit Distribution Test, ntuples 1-12",
+  "rgb_bitdist_all",
+  "\n\
+#========================================================================\n\
+#            RGB Bit Distribution Test, ntuples 1-12\n\
+# This is rgb_bitdist (test 200) for ntuple = 1 through 12 at once, and\n\
+# is what -a runs when no -n is given.  Each width gets its own bits of\n\
+# a single pass over the generator (so the twelve results are as\n\
+# independent as twelve separate runs of rgb_bitdist would be), and\n\
+# each reports a line of its own.  As in rgb_bitdist, the histogram of\n\
+# the number of times one randomly chosen n-tuple value turns up in 64\n\
+# n-tuples is compared with the binomial distribution.\n\
+#\n",
+  100,     /* Default psamples */
+  100000,  /* Default tsamples */
+  RGB_BITDIST_NTMAX,
+  rgb_bitdist_all,
+  0
+};
@@ -23,10 +23,13 @@ typedef struct {
   double x;            /* Extra variable passed on command line */
   double y;            /* Extra variable passed on command line */
   double z;            /* Extra variable passed on command line */
+  dh_context *ctx;     /* Generator, bit buffers and parameters of the run */
 } Test;
 
 
 Test **create_test(Dtest *dtest, unsigned int tsamples, unsigned int psamples);
+Test **create_test_ctx(dh_context *ctx, Dtest *dtest, unsigned int tsamples, unsigned int psamples);
 void destroy_test(Dtest *dtest, Test **test);
 void std_test(Dtest *dtest, Test **test);
+void add_2_test_parallel(Dtest *dtest, Test **test, unsigned int imin, unsigned int imax);
 
@@ -13,6 +13,8 @@
 #include <dieharder/rgb_minimum_distance.h>
 #include <dieharder/rgb_operm.h>
 #include <dieharder/rgb_permutations.h>
+#include <dieharder/rgb_binary_rank.h>
+#include <dieharder/rgb_bitdist_all.h>
 #include <dieharder/dab_birthdays1.h>
 #include <dieharder/dab_bytedistrib.h>
 #include <dieharder/dab_dct.h>
@@ -898,117 +898,170 @@ void get_ntuple_cyclic(unsigned int *input,unsigned int ilen,
  * by the calling routine.
  */
 
-static unsigned int bits_rand[2];   /* A buffer that can handle partial returns */
-static int bleft = -1; /* Number of bits we still need in rand[1] */
-
+/*
+ * The buffers used to live right here as statics.  They are now part
+ * of the run context (dh_context.h) so that every context gets its own
+ * One True Bitstream.  get_uint_rand() is the old interface, and uses
+ * the global context.
+ */
 unsigned int get_uint_rand(gsl_rng *gsl_rng)
 {
 
- static unsigned int bl,bu,tmp;
+ dh_context *ctx = dh_global_context();
 
- /*
-  * First call -- initialize/fill bits_rand from current rng.  bl and bu
-  * should be static so they are preserved for later calls.
-  */
- if(bleft == -1){
-   /* e.g. 32 */
-   bu = sizeof(unsigned int)*CHAR_BIT;
-   /* e.g. 32 - 31 = 1 for a generator that returns 31 bits */
-   bl = bu - rmax_bits;
-   /* For the first call, we start with bits_rand[1] all or partially filled */
-   bits_rand[0] = 0;
-   bits_rand[1] = gsl_rng_get(gsl_rng);
-   /* This is how many bits we still need. */
-   bleft = bu - rmax_bits;
-   /*
-    * The state of the generator is now what it would be on a
-    * typical running call.  bits_rand[1] contains the leftover bits from the
-    * last call (if any).  We now have to interatively fill bits_rand[0],
-    * grab (from the RIGHT) just the number of bits we need to fill the
-    * rest of bits_rand[1] (which might be zero bits).  Then we save bits_rand[1]
-    * for return and move the LEFTOVER (unused) bits from bits_rand[0] into
-    * bits_rand[1], adjust bleft accordingly, and return the uint bits_rand.
-    */
-   MYDEBUG(D_BITS) {
-     printf("bu = %d bl = %d\n",bu,bl);
-     printf("  init: |");
-     dumpbits(&bits_rand[0],bu);
-     printf("|");
-     dumpbits(&bits_rand[1],bu);
-     printf("|\n");
-   }
- }
+ ctx->rng = gsl_rng;
+ return(get_uint_rand_ctx(ctx));
+
+}
+
+unsigned int get_uint_rand_ctx(dh_context *ctx)
+{
+
+ unsigned int tmp;
+
+ dh_uint_fill(ctx,&tmp,1);
+ return(tmp);
+
+}
+
+/*
+ * dh_uint_fill() returns the next n uints of the One True Bitstream, in
+ * one pass.  The stream is built from the rmax_bits valid bits of each
+ * generator return, least significant first: every output uint is
+ * filled from its bit 0 up, first with whatever was left of the last
+ * return, then with as many whole returns as fit, then with the low
+ * bits of one more return, whose high bits are left over for the next
+ * uint.  That is exactly what the old b_window() based get_uint_rand()
+ * did, one uint per call, and this routine reproduces it bit for bit,
+ * including two of its habits that results depend on:
+ *
+ *  a) for 32 bit generators it always ran one return ahead (the first
+ * call pulls two returns and every later call one).
+ *
+ *  b) for shorter generators, when a uint ended exactly at the end of a
+ * return it forgot to clear its buffer, so the NEXT uint came out with
+ * the previous one added to it (mod 2^32).
+ *
+ * We know exactly how many returns the n uints need, so we pull those
+ * (and not one more, as they would be missing from the stream of
+ * whoever draws from the generator next) a block at a time through
+ * dh_rng_fill() and pack them with plain shifts in a 64 bit accumulator.
+ */
+void dh_uint_fill(dh_context *ctx,unsigned int *out,size_t n)
+{
+
+ dh_bitstate *b = &ctx->bits;
+ unsigned int rmax_bits = ctx->rmax_bits;
+ unsigned int rmax_mask = ctx->rmax_mask;
+ unsigned int wbuf[DH_FILL_BLOCK];
+ uint64_t acc;
+ unsigned int nacc,v;
+ size_t i,nwords,iw,nw;
+
+ if(n == 0) return;
 
  /*
-  * We have to iterate into range because it is quite possible that
-  * rmax_bits won't be enough to fill bits_rand[1].
+  * First call.  There is nothing left over, and a 32 bit generator
+  * gets its extra return.
   */
- while(bleft > rmax_bits){
-   /* Get a bits_rand's worth (rmax_bits) into bits_rand[0] */
-   bits_rand[0] = gsl_rng_get(gsl_rng);
-   MYDEBUG(D_BITS) {
-     printf("before %2d: |",bleft);
-     dumpbits(&bits_rand[0],bu);
-     printf("|");
-     dumpbits(&bits_rand[1],bu);
-     printf("|\n");
-   }
-   /* get the good bits only and fill in bits_rand[1] */
-   bits_rand[1] += b_window(bits_rand[0],bu-rmax_bits,bu-1,bleft-rmax_bits);
-   MYDEBUG(D_BITS) {
-     printf(" after %2d: |",bleft);
-     dumpbits(&bits_rand[0],bu);
-     printf("|");
-     dumpbits(&bits_rand[1],bu);
-     printf("|\n");
+ if(b->ufirst){
+   b->ufirst = 0;
+   b->uacc = 0;
+   b->unacc = 0;
+   b->ucarry = 0;
+   b->ulast = 0;
+   if(rmax_bits == 32){
+     b->uacc = (unsigned int) gsl_rng_get(ctx->rng);
    }
-   bleft -= rmax_bits;  /* Number of bits we still need to fill bits_rand[1] */
  }
+ acc = b->uacc;
+ nacc = b->unacc;
 
- /*
-  * We are now in range.  We get just the number of bits we need, from
-  * the right of course, and add them to bits_rand[1].
-  */
- bits_rand[0] = gsl_rng_get(gsl_rng);
- MYDEBUG(D_BITS) {
-   printf("before %2d: |",bleft);
-   dumpbits(&bits_rand[0],bu);
-   printf("|");
-   dumpbits(&bits_rand[1],bu);
-   printf("|\n");
- }
- if(bleft != 0) {
-   bits_rand[1] += b_window(bits_rand[0],bu-bleft,bu-1,0);
+ if(rmax_bits == 32){
+   nwords = n;
+ } else {
+   nwords = ((uint64_t) 32*n - nacc + rmax_bits - 1)/rmax_bits;
  }
  MYDEBUG(D_BITS) {
-   printf(" after %2d: |",bleft);
-   dumpbits(&bits_rand[0],bu);
-   printf("|");
-   dumpbits(&bits_rand[1],bu);
-   printf("|\n");
+   printf("dh_uint_fill(): %lu uints from %lu returns of %u bits\n",(unsigned long) n,(unsigned long) nwords,rmax_bits);
  }
- /* Save for return */
- tmp = bits_rand[1];
- /*
-  * Move the leftover bits from bits_rand[0] into bits_rand[1] (right
-  * justified), adjust bleft accordingly, and return.  Note that if we
-  * exactly filled the return with ALL the bits in rand[0] then we
-  * need to start over on the next one.
-  */
- if(bleft == rmax_bits){
-   bleft = bu;
+
+ iw = nw = 0;
+ if(rmax_bits == 32){
+   for(i=0;i<n;i++){
+     if(iw == nw){
+       nw = nwords > DH_FILL_BLOCK ? DH_FILL_BLOCK : nwords;
+       dh_rng_fill(ctx->rng,wbuf,nw);
+       nwords -= nw;
+       iw = 0;
+     }
+     out[i] = (unsigned int) acc;
+     acc = wbuf[iw++];
+   }
  } else {
-   bits_rand[1] = b_window(bits_rand[0],bu-rmax_bits,bu-bleft-1,bu-rmax_bits+bleft);
-   bleft = bu - rmax_bits + bleft;
-   MYDEBUG(D_BITS) {
-     printf("  done %2d: |",bleft);
-     dumpbits(&bits_rand[0],bu);
-     printf("|");
-     dumpbits(&bits_rand[1],bu);
-     printf("|\n");
+   for(i=0;i<n;i++){
+     while(nacc < 32){
+       if(iw == nw){
+         nw = nwords > DH_FILL_BLOCK ? DH_FILL_BLOCK : nwords;
+         dh_rng_fill(ctx->rng,wbuf,nw);
+         nwords -= nw;
+         iw = 0;
+       }
+       acc |= (uint64_t)(wbuf[iw++] & rmax_mask) << nacc;
+       nacc += rmax_bits;
+     }
+     v = (unsigned int) acc;
+     acc >>= 32;
+     nacc -= 32;
+     if(b->ucarry) v += b->ulast;
+     b->ucarry = (nacc == 0);
+     b->ulast = v;
+     out[i] = v;
    }
  }
- return(tmp);
+
+ b->uacc = acc;
+ b->unacc = nacc;
+
+}
+
+/*
+ * Promise the bit reader (dh_bits_get(), see dh_bits.h) that the next
+ * nbits bits will be read through it and nothing else, so that it can
+ * fetch the words it needs for them a block at a time.  Never promise
+ * more than you read: words fetched and not read are lost to whoever
+ * draws from the generator next.
+ */
+void dh_bits_reserve(dh_context *ctx,off_t nbits)
+{
+
+ dh_bitstate *b = &ctx->bits;
+ off_t have;
+
+ have = b->nacc + ((off_t)(b->wlen - b->wpos) + b->budget)*ctx->rmax_bits;
+ if(nbits > have){
+   b->budget += (nbits - have + ctx->rmax_bits - 1)/ctx->rmax_bits;
+ }
+ MYDEBUG(D_BITS) {
+   printf("dh_bits_reserve(): %lu bits, budget now %lu words\n",(unsigned long) nbits,(unsigned long) b->budget);
+ }
+
+}
+
+/*
+ * Fetch the next block of promised words into wbuf.
+ */
+void dh_bits_refill(dh_context *ctx)
+{
+
+ dh_bitstate *b = &ctx->bits;
+ unsigned int n;
+
+ n = b->budget > DH_BITS_WBUF ? DH_BITS_WBUF : (unsigned int) b->budget;
+ dh_rng_fill(ctx->rng,b->wbuf,n);
+ b->budget -= n;
+ b->wpos = 0;
+ b->wlen = n;
 
 }
 
@@ -1019,29 +1072,95 @@ unsigned int get_uint_rand(gsl_rng *gsl_rng)
  * of arbitrary size -- we make the return a void pointer whose size is
  * specified by the caller (and guaranteed to be big enough to hold
  * the result).
+ *
+ * The bits come out of a streaming buffer of uints from dh_uint_fill()
+ * (ctx->bits.rbuf, see dh_context.h), read least significant bit first
+ * from rbuf[0] on, so each window is simply the next nbits of the
+ * stream as one (possibly very long) integer.  The window is written
+ * into result a uint at a time, least significant uint LAST, and
+ * aligned with the END of result, so for rsize = 4 it is just the uint
+ * and for rsize = 16 it is four uints, most significant first.  That is
+ * precisely what the old six uint circulating buffer version returned
+ * (up to the 128 bits it could handle).  That version also always held
+ * five whole uints beyond the one being read, so we stay DH_RBITS_AHEAD
+ * uints ahead too and leave the generator exactly where it always was
+ * for whoever draws from it next.  dh_rand_bits_reserve()
+ * lets a caller who knows how many bits it is going to want have them
+ * fetched a block at a time.  get_rand_bits() is the old interface,
+ * and uses the global context.
+ */
+void get_rand_bits(void *result,unsigned int rsize,unsigned int nbits,gsl_rng *gsl_rng)
+{
+
+ dh_context *ctx = dh_global_context();
+
+ ctx->rng = gsl_rng;
+ get_rand_bits_ctx(result,rsize,nbits,ctx);
+
+}
+
+/*
+ * Promise get_rand_bits_ctx() that the next nbits bits will be read
+ * through it (and that the generator will not be drawn from otherwise
+ * in the meantime).  As with dh_bits_reserve(), never promise more than
+ * you read.
  */
+void dh_rand_bits_reserve(dh_context *ctx,off_t nbits)
+{
+
+ dh_bitstate *b = &ctx->bits;
+ off_t limit;
+
+ limit = (b->rbase*32 + b->rbit + nbits + 31)/32 + DH_RBITS_AHEAD;
+ if(limit > b->rlimit) b->rlimit = limit;
+ MYDEBUG(D_BITS) {
+   printf("dh_rand_bits_reserve(): %lu bits, limit now %lu uints\n",(unsigned long) nbits,(unsigned long) b->rlimit);
+ }
+
+}
 
 /*
- * We'll use a BIG static circulating buffer so we can handle BIG
- * lags without worrying too much about it.  Space is cheap in the
- * one-page range.
+ * Make sure that rbuf holds the next nbits bits and DH_RBITS_AHEAD
+ * whole uints beyond them, fetching more (as many as were promised and
+ * fit) if it doesn't.  Uints already read are dropped from the front
+ * of the buffer to make room.
  */
-#define BRBUF 6
-static unsigned int bits_randbuf[BRBUF];
-static unsigned int bits_output[BRBUF];
-/* pointer to line containing LAST return */
-static int brindex = -1;
-/* pointer to region being backfilled */
-static int iclear = -1;
-/* pointer to the last (most significant) returned bit */
-static int bitindex = -1;
+static void dh_rand_bits_need(dh_context *ctx,unsigned int nbits)
+{
 
-void get_rand_bits(void *result,unsigned int rsize,unsigned int nbits,gsl_rng *gsl_rng)
+ dh_bitstate *b = &ctx->bits;
+ unsigned int need,keep,first;
+ off_t n,more;
+
+ need = (b->rbit + nbits + 31)/32 + DH_RBITS_AHEAD;
+ if(b->rlen >= need) return;
+
+ first = b->rbit/32;
+ if(first > 0){
+   keep = b->rlen - first;
+   memmove(b->rbuf,&b->rbuf[first],keep*sizeof(unsigned int));
+   b->rlen = keep;
+   b->rbase += first;
+   b->rbit -= first*32;
+   need -= first;
+ }
+
+ n = need - b->rlen;
+ more = b->rlimit - (b->rbase + b->rlen);
+ if(more > DH_RBITS_BUF - b->rlen) more = DH_RBITS_BUF - b->rlen;
+ if(more > n) n = more;
+ dh_uint_fill(ctx,&b->rbuf[b->rlen],(size_t) n);
+ b->rlen += n;
+
+}
+
+void get_rand_bits_ctx(void *result,unsigned int rsize,unsigned int nbits,dh_context *ctx)
 {
 
- int i,offset;
- unsigned int bu;
- char *output,*resultp;
+ dh_bitstate *b = &ctx->bits;
+ unsigned int bu,k,nk,nb,i,s,w;
+ int off;
+ char *resultp = (char *)result;
 
  /*
   * Zero the return.  Note rsize is in characters/bytes.
@@ -1052,141 +1171,41 @@ void get_rand_bits(void *result,unsigned int rsize,unsigned int nbits,gsl_rng *g
  }
 
  /*
-  * We have to do a bit of testing on call parameters.  We cannot return
-  * more bits than the result buffer will hold.  We return 0 if nbits = 0.
-  * We cannot return more bits than bits_randbuf[] will hold.
+  * We cannot return more bits than the result buffer will hold.  We
+  * return 0 if nbits = 0.
   */
  bu = sizeof(unsigned int)*CHAR_BIT;
  if(nbits == 0) return;  /* Handle a "dumb call" */
- if(nbits > (BRBUF-2)*bu){
-   fprintf(stderr,"Warning:  get_rand_bits capacity exceeded!\n");
-   fprintf(stderr," nbits = %d > %d (nbits max)\n",nbits,(BRBUF-2)*bu);
-   return;
- }
  if(nbits > rsize*CHAR_BIT){
    fprintf(stderr,"Warning:  Cannot get more bits than result vector will hold!\n");
    fprintf(stderr," nbits = %d > %d (rsize max bits)\n",nbits,rsize*CHAR_BIT);
    return;   /* Unlikely, but possible */
  }
 
- if(brindex == -1){
-   /*
-    * First call, fill the buffer BACKWARDS.  I know this looks odd,
-    * but we have to think of bits coming off the generator from least
-    * significant on the right to most significant on the left as
-    * filled by get_uint_rand(), so we have to do it this way to avoid
-    * a de-facto shuffle for generators with rmax_bits < 32.
-    */
-   for(i=BRBUF-1;i>=0;i--) {
-     bits_randbuf[i] = get_uint_rand(gsl_rng);
-     /* printf("bits_randbuf[%d] = %u\n",i,bits_randbuf[i]); */
-   }
-   /*
-    * Set the pointers to point to the last line, and the bit AFTER the
-    * last bit.  Note that iclear should always start equal to brindex
-    * as one enters the next code segment.
-    */
-   brindex = BRBUF;
-   iclear = brindex-1;
-   bitindex = 0;
-   MYDEBUG(D_BITS) {
-     printf("Initialization: iclear = %d  brindex = %d   bitindex = %d\n",iclear,brindex,bitindex);
-   }
- }
- MYDEBUG(D_BITS) {
-   for(i=0;i<BRBUF;i++){
-     printf("%2d: ",i);
-     dumpuintbits(&bits_randbuf[i],1);
-     printf("\n");
-   }
- }
- /*
-  * OK, the logic here is: grab a window that fills the bit request
-  * precisely (determining the starting buffer index and offset
-  * beforehand) and put it into bits_output;  backfill WHOLE uints from
-  * the END of the window to the last uint before the BEGINNING of the
-  * window, (in reverse order!)
-  */
-
- /*
-  * Get starting indices.  Shift the buffer index back by the number of
-  * whole uints in nbits, then shift back the bit index back by the
-  * modulus/remainder, then handle a negative result (borrow), then finally
-  * deal with wraparound of the main index as well.
-  */
- brindex -= nbits/bu;
- bitindex = bitindex - nbits%bu;
- if(bitindex < 0) {
-   /* Have to borrow from previous uint */
-   brindex--;                /* So we push back one more */
-   bitindex += bu;           /* and find the new bitindex */
- }
- if(brindex < 0) brindex += BRBUF;  /* Oops, need to wrap around */
- MYDEBUG(D_BITS) {
-   printf("  Current Call: iclear = %d  brindex = %d   bitindex = %d\n",iclear,brindex,bitindex);
- }
-
- /*
-  * OK, so we want a window nbits long, starting in the uint indexed
-  * by brindex, displaced by bitindex.
-  */
- offset = brindex*bu + bitindex;
- MYDEBUG(D_BITS) {
-   printf("   Window Call: tuple = %d  offset = %d\n",nbits,offset);
- }
- get_ntuple_cyclic(bits_randbuf,BRBUF,bits_output,BRBUF,nbits,offset);
- /* Handle case where we returned whole uint at brindex location */
- MYDEBUG(D_BITS) {
-   printf("   Cleaning up:  iclear = %d  brindex = %d  bitindex = %d\n",iclear,brindex,bitindex);
- }
-
- /*
-  * Time to backfill.  We walk backwards, filling until we reach
-  * the current index.
-  */
- while(iclear != brindex){
-   bits_randbuf[iclear--] = get_uint_rand(gsl_rng);
-   if(iclear < 0) iclear += BRBUF;  /* wrap on around */
- }
  /*
-  * Dump the refilled buffer
+  * Read the window a uint at a time, least significant first.  The k-th
+  * uint goes to bytes rsize-4*(k+1) on of result; only the last one can
+  * stick out of the front of result (when rsize isn't a multiple of 4),
+  * and then just its trailing bytes are copied, as they always were.
   */
- MYDEBUG(D_BITS) {
-   for(i=0;i<BRBUF;i++){
-     printf("%2d: ",i);
-     dumpuintbits(&bits_randbuf[i],1);
-     printf("\n");
+ nk = (nbits + bu - 1)/bu;
+ for(k=0;k<nk;k++){
+   nb = (k == nk-1 && nbits%bu) ? nbits%bu : bu;
+   dh_rand_bits_need(ctx,nb);
+   i = b->rbit/bu;
+   s = b->rbit%bu;
+   w = (unsigned int)((((uint64_t) b->rbuf[i+1] << 32) | b->rbuf[i]) >> s);
+   if(nb < bu) w &= (1u << nb) - 1;
+   b->rbit += nb;
+   off = (int) rsize - (int)((k+1)*sizeof(unsigned int));
+   if(off >= 0){
+     memcpy(&resultp[off],&w,sizeof(unsigned int));
+   } else {
+     memcpy(resultp,(char *)&w - off,sizeof(unsigned int) + off);
    }
- }
-
- /*
-  * At this point iclear SHOULD equal brindex, guaranteed, and bits_output
-  * contains the answer desired.  However, NOW we have to copy this answer
-  * back into result, a byte at a time, in reverse order.
-  */
- MYDEBUG(D_BITS) {
-   printf("bits_output[%d] = ",BRBUF-1);
-   dumpuintbits(&bits_output[BRBUF-1],1);
-   printf("\n");
- }
-
- /*
-  * Get and align addresses of char *pointers into bits_output and result
-  */
- output = (char *)&bits_output[BRBUF]-rsize;
- resultp = (char *)result;
- MYDEBUG(D_BITS) {
-   printf("rsize = %d  output address = %p result address = %p\n",rsize,output,resultp);
- }
-
- /* copy them over characterwise */
- for(i=0;i<rsize;i++){
-   resultp[i] = output[i];
    MYDEBUG(D_BITS) {
-     printf(" Returning: result[%d} = ",i);
-     dumpbits((unsigned int *)&resultp[i],8);
-     printf(" output[%d} = ",i);
-     dumpbits((unsigned int *)&output[i],8);
+     printf(" Returning uint %u of window = ",k);
+     dumpuintbits(&w,1);
      printf("\n");
    }
  }
@@ -1272,8 +1291,6 @@ void mybitadd(char *dst, int doffset, char *src, int soffset, int slen)
 
 }
 
-/* static unsigned int pattern_output[BRBUF]; */
-
 void get_rand_pattern(void *result,unsigned int rsize,int *pattern,gsl_rng *gsl_rng)
 {
 
@@ -1315,15 +1332,10 @@ void get_rand_pattern(void *result,unsigned int rsize,int *pattern,gsl_rng *gsl_
  /*
   * We have to do a bit of testing on call parameters.  We cannot return
   * more bits than the result buffer will hold.  We return 0 if nbits = 0.
-  * We cannot return more bits than bits_randbuf[] or result[] will hold.
+  * We cannot return more bits than result[] will hold.
   */
  bu = sizeof(unsigned int)*CHAR_BIT;
  if(nbits == 0) return;  /* Handle a "dumb call" */
- if(nbits > (BRBUF-2)*bu){
-   fprintf(stderr,"Warning:  get_rand_bits capacity exceeded!\n");
-   fprintf(stderr," nbits = %d > %d (nbits max)\n",nbits,(BRBUF-2)*bu);
-   return;
- }
  if(nbits > rsize*CHAR_BIT){
    fprintf(stderr,"Warning:  Cannot get more bits than result vector will hold!\n");
    fprintf(stderr," nbits = %d > %d (rsize max bits)\n",nbits,rsize*CHAR_BIT);
@@ -1420,22 +1432,14 @@ void get_rand_pattern(void *result,unsigned int rsize,int *pattern,gsl_rng *gsl_
 
 /*
  * The bits.c module doesn't malloc anything, but it does maintain some
- * static buffers that must be cleared in order to achieve consistent
- * results from a rng reseed on, per run.
+ * buffers (now in the run context) that must be cleared in order to
+ * achieve consistent results from a rng reseed on, per run.  This
+ * clears the buffers of the global context; see dh_context_reset_bits()
+ * for everything else.
  */
 void reset_bit_buffers()
 {
 
-  int i;
-  
-  bits_rand[0] = bits_rand[1] = 0;
-  bleft = -1;
-  for(i = 0;i<BRBUF;i++){
-    bits_randbuf[i] = 0;
-    bits_output[i] = 0;
-  }
-  brindex = -1;
-  iclear = -1;
-  bitindex = -1;
+ dh_context_reset_bits(dh_global_context());
 
 }
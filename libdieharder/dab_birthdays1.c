@@ -48,26 +48,26 @@
 #define NMS 4096 /* Maximum value */
 #define DEFAULT_NMS 1700
 
-static double lambda;
-static unsigned int *intervals;
-static unsigned int nms,nbits,kmax;
-
 int dab_birthdays1(Test **test, int irun)
 {
 
  uint i,k,t,m,mnext;
+ uint nms,nbits,kmax;
+ uint *intervals;
+ double lambda;
  uint *js;
  uint rand_uint[NMS];
  
  double binfreq;
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * for display only.
   */
- test[0]->ntuple = rmax_bits;
+ test[0]->ntuple = ctx->rmax_bits;
 
- nms = ntuple == 0 ? DEFAULT_NMS : ntuple;
- nbits = rmax_bits;
+ nms = ctx->ntuple == 0 ? DEFAULT_NMS : ctx->ntuple;
+ nbits = ctx->rmax_bits;
 
  /*
   * This is the one thing that matters.  We're going to make the
@@ -124,9 +124,7 @@ int dab_birthdays1(Test **test, int irun)
   */
  for(t=0;t<test[0]->tsamples;t++) {
 	/* Fill the array with nms samples; each will be rmax_bits long */
-   for(m = 0;m<nms;m++){
-	 rand_uint[m] = gsl_rng_get(rng);
-   }
+   dh_rng_fill(ctx->rng,rand_uint,nms);
 
    /*
     * The actual test logic starts right here.  We have nms random ints
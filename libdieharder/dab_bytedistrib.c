@@ -34,6 +34,8 @@ int dab_bytedistrib(Test **test,int irun) {
  Vtest vtest;
  unsigned int t,i,j;
  unsigned int counts[TABLE_SIZE];
+ unsigned int words[SAMP_TOTAL / SAMP_PER_WORD];
+ dh_context *ctx = test[0]->ctx;
 
  /* Zero the counters */
  memset(counts, 0, sizeof(unsigned int) * TABLE_SIZE);
@@ -41,12 +43,13 @@ int dab_bytedistrib(Test **test,int irun) {
  test[0]->ntuple = 0;  // Not used currently
 
  for(t=0;t<test[0]->tsamples;t++){
+   dh_rng_fill(ctx->rng,words,SAMP_TOTAL / SAMP_PER_WORD);
    for(i=0;i<(SAMP_TOTAL / SAMP_PER_WORD);i++){
 
      /*
       * Generate a word; this word will be used for SAMP_PER_WORD bytes.
       */
-     unsigned int word = gsl_rng_get(rng);
+     unsigned int word = words[i];
      unsigned char currentShift = 0;
      for (j = 0; j < SAMP_PER_WORD; j++) {
 
@@ -60,7 +63,7 @@ int dab_bytedistrib(Test **test,int irun) {
         * shift amounts correctly (at least I think it does; confirmed for
         * SAMP_PER_WORD==3 and a variety of rmax_bits values).
         */
-       unsigned char shiftAmount = ((j+1) * (rmax_bits - 8)) / (SAMP_PER_WORD - 1);
+       unsigned char shiftAmount = ((j+1) * (ctx->rmax_bits - 8)) / (SAMP_PER_WORD - 1);
        unsigned int v = word & 0x0ff;    /* v is the byte sampled from the word */
        word >>= shiftAmount - currentShift;
        currentShift += shiftAmount;
@@ -36,7 +36,7 @@
 
 #include <dieharder/libdieharder.h>
 
-#define RotL(x,N)    (rmax_mask & (((x) << (N)) | ((x) >> (rmax_bits-(N)))))
+#define RotL(x,N)    (ctx->rmax_mask & (((x) << (N)) | ((x) >> (ctx->rmax_bits-(N)))))
 
 void fDCT2(const unsigned int input[], double output[], size_t len);
 void iDCT2(const double input[], double output[], size_t len);
@@ -78,13 +78,14 @@ double evalMostExtreme(double *pvalue, unsigned int num);
 
 int dab_dct(Test **test,int irun)
 {
+ dh_context *ctx = test[0]->ctx;
  double *dct;
  unsigned int *input;
  double *pvalues = NULL;
  unsigned int i, j;
- unsigned int len = (ntuple == 0) ? 256 : ntuple;
+ unsigned int len = (ctx->ntuple == 0) ? 256 : ctx->ntuple;
  int rotAmount = 0;
- unsigned int v = 1<<(rmax_bits-1);
+ unsigned int v = 1<<(ctx->rmax_bits-1);
  double mean = (double) len * (v - 0.5);
 
  /* positionCounts is only used by the primary test, and not by the
@@ -133,12 +134,12 @@ int dab_dct(Test **test,int irun)
     * have been used.
     */
    if (j != 0 && (j % (test[0]->tsamples / 4) == 0)) {
-     rotAmount += rmax_bits/4;
+     rotAmount += ctx->rmax_bits/4;
    }
 
    /* Read (and rotate) the actual rng words. */
+   dh_rng_fill(ctx->rng, input, len);
    for (i=0; i<len; i++) {
-     input[i] = gsl_rng_get(rng);
      input[i] = RotL(input[i], rotAmount);
    }
 
@@ -25,12 +25,15 @@ extern double evalMostExtreme(double *pvalue, uint num);
 
 int dab_monobit2(Test **test, int irun)
 {
+ dh_context *ctx = test[0]->ctx;
  uint i, j;
- uint blens = rmax_bits;
- uint ntup = ntuple;
+ uint blens = ctx->rmax_bits;
+ uint ntup = ctx->ntuple;
  double *counts;
  uint *tempCount;
  double pvalues[BLOCK_MAX];
+ uint buf[DH_FILL_BLOCK];
+ uint nbuf = 0, ibuf = 0;
 
  /* First, find out the maximum block size to use.
   * The maximum size will be 2^ntup words.
@@ -53,7 +56,13 @@ int dab_monobit2(Test **test, int irun)
  memset(tempCount, 0, sizeof(*tempCount) * ntup);
 
  for(i=0;i<test[0]->tsamples;i++) {
-   uint n = gsl_rng_get(rng);
+   if(ibuf == nbuf){
+     nbuf = test[0]->tsamples - i;
+     if(nbuf > DH_FILL_BLOCK) nbuf = DH_FILL_BLOCK;
+     dh_rng_fill(ctx->rng,buf,nbuf);
+     ibuf = 0;
+   }
+   uint n = buf[ibuf++];
    uint t = 1;
 
    // Begin: count bits
@@ -51,6 +51,7 @@ int dab_opso2(Test **test, int irun) {
  Xtest ptest1, ptest2;
  unsigned int w1[524288], w2[524288];  /* 2^24 positions = 2^5 * 2^19; 2^19 = 524288 */
  unsigned int mask[32];      /* Masks to take the place of a bitset operation */
+ dh_context *ctx = test[0]->ctx;
 
  for (i = 0; i < 32; i++) mask[i] = 1<<i;
 
@@ -58,7 +59,7 @@ int dab_opso2(Test **test, int irun) {
  test[1]->ntuple = 1;
 
  /* If the generator word size is too small, abort early. */
- if (rmax_bits < 24) {
+ if (ctx->rmax_bits < 24) {
    test[0]->pvalues[irun] = 0.5;
    test[1]->pvalues[irun] = 0.5;
    if (irun == 0) {
@@ -93,8 +94,8 @@ int dab_opso2(Test **test, int irun) {
   */
  for(t=0;t<test[0]->tsamples;t++) {  /* Start main loop */
    if(t%2 == 0) {  // Get two inputs every other round
-     j0 = gsl_rng_get(rng);
-     k0 = gsl_rng_get(rng);
+     j0 = gsl_rng_get(ctx->rng);
+     k0 = gsl_rng_get(ctx->rng);
 
      w1[(j0 >> 5) % 524288] |= mask[j0 % 32];
      j = j0 & 0x0fff;
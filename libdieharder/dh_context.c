@@ -0,0 +1,252 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * Allocation and management of dh_context, the per-run state that a
+ * test needs (generator, bit buffers, run parameters, scratch space).
+ * See dh_context.h for the rationale.
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+/*
+ * The shim context that mirrors the globals.  It is only ever used
+ * through dh_global_context().
+ */
+static dh_context global_ctx;
+static int global_ctx_init = 0;
+
+/*
+ * Allocate a new context for rng, with its run parameters copied from
+ * the current values of the globals.  The context does NOT own rng;
+ * the caller frees it (after dh_context_free()) as usual.
+ */
+dh_context *dh_context_alloc(gsl_rng *rng)
+{
+
+ dh_context *ctx;
+
+ ctx = (dh_context *)malloc(sizeof(dh_context));
+ memset(ctx,0,sizeof(dh_context));
+ dh_context_load_globals(ctx);
+ dh_context_set_rng(ctx,rng);
+
+ MYDEBUG(D_STD_TEST){
+   fprintf(stdout,"# dh_context_alloc(): rmax_bits = %u\n",ctx->rmax_bits);
+ }
+
+ return(ctx);
+
+}
+
+void dh_context_free(dh_context *ctx)
+{
+
+ if(ctx == 0 || ctx->global) return;
+ if(ctx->work) nullfree(ctx->work);
+ free(ctx);
+
+}
+
+/*
+ * Attach a generator to a context.  We count its significant bits
+ * and build its mask exactly the way choose_rng() does for the globals,
+ * and empty the bit buffers, since bits left over from some other
+ * generator have no business in this stream.
+ */
+void dh_context_set_rng(dh_context *ctx,gsl_rng *rng)
+{
+
+ unsigned int rmax;
+
+ ctx->rng = rng;
+ ctx->random_max = 0;
+ ctx->rmax_bits = 0;
+ ctx->rmax_mask = 0;
+ if(rng){
+   ctx->random_max = gsl_rng_max(rng);
+   rmax = ctx->random_max;
+   while(rmax){
+     rmax >>= 1;
+     ctx->rmax_mask = ctx->rmax_mask << 1;
+     ctx->rmax_mask++;
+     ctx->rmax_bits++;
+   }
+ }
+ dh_context_reset_bits(ctx);
+
+}
+
+/*
+ * Copy the run parameters from the globals into the context.  This does
+ * not touch the generator or the bit buffers.
+ */
+void dh_context_load_globals(dh_context *ctx)
+{
+
+ ctx->all = all;
+ ctx->ks_test = ks_test;
+ ctx->multiply_p = multiply_p;
+ ctx->ntuple = ntuple;
+ ctx->overlap = overlap;
+ ctx->psamples = psamples;
+ ctx->tsamples = tsamples;
+ ctx->Xtrategy = Xtrategy;
+ ctx->Xstep = Xstep;
+ ctx->Xoff = Xoff;
+ ctx->x_user = x_user;
+ ctx->y_user = y_user;
+ ctx->z_user = z_user;
+ ctx->seed = seed;
+ ctx->jobs = jobs;
+
+}
+
+/*
+ * A new context for rng with the run parameters of parent (NOT the
+ * globals, which may have moved on) and empty bit buffers and workspace.
+ * It runs serially (jobs = 1), as it is usually one of parent's workers.
+ */
+dh_context *dh_context_clone(dh_context *parent,gsl_rng *rng)
+{
+
+ dh_context *ctx;
+
+ ctx = (dh_context *)malloc(sizeof(dh_context));
+ memcpy(ctx,parent,sizeof(dh_context));
+ ctx->work = 0;
+ ctx->work_size = 0;
+ ctx->global = 0;
+ ctx->jobs = 1;
+ dh_context_set_rng(ctx,rng);
+
+ return(ctx);
+
+}
+
+/*
+ * The bit routines keep some buffers that must be cleared in order to
+ * achieve consistent results from a rng reseed on, per run.
+ */
+void dh_context_reset_bits(dh_context *ctx)
+{
+
+ memset(&ctx->bits,0,sizeof(dh_bitstate));
+ ctx->bits.ufirst = 1;
+
+}
+
+/*
+ * Return a scratch buffer of at least size bytes.  The buffer belongs to
+ * the context and is reused (and grown as needed) from call to call, so
+ * tests that need the same large temporary every psample don't have to
+ * malloc and free it every time.  The contents are NOT preserved.
+ */
+void *dh_context_workspace(dh_context *ctx,size_t size)
+{
+
+ if(size > ctx->work_size){
+   if(ctx->work) nullfree(ctx->work);
+   ctx->work = malloc(size);
+   if(ctx->work == 0){
+     fprintf(stderr,"Error: dh_context_workspace() cannot allocate %lu bytes.\n",(unsigned long) size);
+     exit(1);
+   }
+   ctx->work_size = size;
+ }
+ return(ctx->work);
+
+}
+
+/*
+ * The global shim.  Every call refreshes the context from the globals
+ * (including rng, rmax_bits and rmax_mask as set by the UI) but leaves
+ * the bit buffers alone, so bits flow from call to call precisely as
+ * they did when they lived in static variables.
+ */
+dh_context *dh_global_context()
+{
+
+ if(global_ctx_init == 0){
+   memset(&global_ctx,0,sizeof(dh_context));
+   dh_context_reset_bits(&global_ctx);
+   global_ctx.global = 1;
+   global_ctx_init = 1;
+ }
+ dh_context_load_globals(&global_ctx);
+ global_ctx.rng = rng;
+ global_ctx.random_max = random_max;
+ global_ctx.rmax_bits = rmax_bits;
+ global_ctx.rmax_mask = rmax_mask;
+
+ return(&global_ctx);
+
+}
+
+/*
+ * A generator can only be run in several contexts at once (each with
+ * its own instance, allocated from rng->type) if every instance has its
+ * own state.  Generators that read a file or a pipe or that keep their
+ * state in static variables cannot, and must be run serially.
+ */
+static int dh_rng_type_can_clone(const char *name)
+{
+
+ if(strncmp(name,"file_input",10) == 0 ||
+    strncmp(name,"stdin_input",11) == 0 ||
+    strcmp(name,"shm_input") == 0 ||
+    strncmp(name,"R_",2) == 0 ||
+    strcmp(name,"ca") == 0) return(0);
+
+ return(1);
+
+}
+
+int dh_rng_can_clone(gsl_rng *rng)
+{
+
+ int i;
+ const char *name;
+
+ if(rng == 0) return(0);
+ name = dh_rng_half64_inner(rng->type)->name;
+ if(strncmp(name,"XOR",3) == 0){
+   for(i=1;i<gvcount;i++){
+     if(dh_rng_types[gnumbs[i]] == 0) return(0);
+     if(!dh_rng_type_can_clone(dh_rng_types[gnumbs[i]]->name)) return(0);
+   }
+   return(1);
+ }
+
+ return(dh_rng_type_can_clone(name));
+
+}
+
+/*
+ * Derive the seed of the index'th independent stream of a run from the
+ * run's seed, e.g. for one psample or one test of a parallel run.  This
+ * is the splitmix64 finalizer of base + (index+1)*golden ratio, so that
+ * neighboring indices get thoroughly unrelated seeds.  The result is
+ * kept to 32 bits (and nonzero) as most generators only use that much
+ * of a seed anyway.
+ */
+unsigned long int dh_seed_derive(unsigned long int base,unsigned long int index)
+{
+
+ uint64_t z;
+
+ z = (uint64_t) base + ((uint64_t) index + 1)*0x9E3779B97F4A7C15ULL;
+ z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+ z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+ z = z ^ (z >> 31);
+ z &= 0xffffffff;
+ if(z == 0) z = 1;
+
+ return((unsigned long int) z);
+
+}
@@ -0,0 +1,199 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * The producer side of the shm_input ring (see dh_shm.h for the layout
+ * and the protocol).  This file needs nothing from the rest of dieharder
+ * so that it can be built straight into a producer.
+ *========================================================================
+ */
+
+#define _GNU_SOURCE 1
+#include <dieharder/dh_shm.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+struct dh_shm_producer {
+  char *name;
+  dh_shm_header *h;
+  unsigned char *data;
+  size_t maplen;
+  uint64_t head;                /* Our copy of h->head */
+  uint64_t tail;                /* The last h->tail we saw */
+};
+
+/*
+ * Wait until *seq is no longer seq (or a spurious wakeup), or wake
+ * everybody waiting on seq.  Without futexes we just yield.
+ */
+static void dh_shm_wait(uint32_t *seq,uint32_t val)
+{
+#if defined(__linux__) && defined(SYS_futex)
+ syscall(SYS_futex,seq,FUTEX_WAIT,val,NULL,NULL,0);
+#else
+ (void) seq;
+ (void) val;
+ sched_yield();
+#endif
+}
+
+static void dh_shm_wake(uint32_t *seq)
+{
+#if defined(__linux__) && defined(SYS_futex)
+ syscall(SYS_futex,seq,FUTEX_WAKE,1,NULL,NULL,0);
+#else
+ (void) seq;
+#endif
+}
+
+dh_shm_producer *dh_shm_producer_create(const char *name,size_t size,unsigned int word_size)
+{
+
+ dh_shm_producer *p;
+ size_t s;
+ void *m;
+ int fd;
+
+ if(size == 0) size = DH_SHM_SIZE;
+ for(s = 4096;s < size;s <<= 1);
+ if(word_size != 4 && word_size != 8){
+   errno = EINVAL;
+   return(NULL);
+ }
+
+ shm_unlink(name);
+ fd = shm_open(name,O_RDWR | O_CREAT | O_EXCL,0600);
+ if(fd < 0) return(NULL);
+ if(ftruncate(fd,(off_t)(DH_SHM_HEADER + s)) != 0){
+   close(fd);
+   shm_unlink(name);
+   return(NULL);
+ }
+ m = mmap(NULL,DH_SHM_HEADER + s,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+ close(fd);
+ if(m == MAP_FAILED){
+   shm_unlink(name);
+   return(NULL);
+ }
+
+ p = (dh_shm_producer *) calloc(1,sizeof(dh_shm_producer));
+ p->name = strdup(name);
+ p->h = (dh_shm_header *) m;
+ p->data = (unsigned char *) m + DH_SHM_HEADER;
+ p->maplen = DH_SHM_HEADER + s;
+
+ /*
+  * The segment is zero filled, so head, tail, the seqs and flags are
+  * already 0.  magic goes in last, so a consumer that sees it sees the
+  * rest.
+  */
+ p->h->version = DH_SHM_VERSION;
+ p->h->word_size = word_size;
+ p->h->header_size = DH_SHM_HEADER;
+ p->h->size = s;
+ __atomic_store_n(&p->h->magic,DH_SHM_MAGIC,__ATOMIC_RELEASE);
+
+ return(p);
+
+}
+
+/*
+ * Bytes free, waiting until there is at least one, or 0 if the consumer
+ * is gone.
+ */
+static size_t dh_shm_room(dh_shm_producer *p)
+{
+
+ dh_shm_header *h = p->h;
+ uint32_t seq;
+
+ while(1){
+   seq = __atomic_load_n(&h->space_seq,__ATOMIC_ACQUIRE);
+   p->tail = __atomic_load_n(&h->tail,__ATOMIC_ACQUIRE);
+   if(p->head - p->tail < h->size) return(h->size - (p->head - p->tail));
+   if(__atomic_load_n(&h->detached,__ATOMIC_ACQUIRE)) return(0);
+   __atomic_store_n(&h->producer_waiting,1,__ATOMIC_SEQ_CST);
+   dh_shm_wait(&h->space_seq,seq);
+   __atomic_store_n(&h->producer_waiting,0,__ATOMIC_RELAXED);
+ }
+
+}
+
+void *dh_shm_producer_reserve(dh_shm_producer *p,size_t *n)
+{
+
+ size_t room,pos;
+
+ room = dh_shm_room(p);
+ if(room == 0){
+   *n = 0;
+   errno = EPIPE;
+   return(NULL);
+ }
+ pos = p->head & (p->h->size - 1);
+ if(room > p->h->size - pos) room = p->h->size - pos;
+ if(*n > room) *n = room;
+ return(p->data + pos);
+
+}
+
+void dh_shm_producer_commit(dh_shm_producer *p,size_t n)
+{
+
+ dh_shm_header *h = p->h;
+
+ p->head += n;
+ __atomic_store_n(&h->head,p->head,__ATOMIC_RELEASE);
+ __atomic_add_fetch(&h->data_seq,1,__ATOMIC_SEQ_CST);
+ if(__atomic_load_n(&h->consumer_waiting,__ATOMIC_SEQ_CST)) dh_shm_wake(&h->data_seq);
+
+}
+
+int dh_shm_producer_write(dh_shm_producer *p,const void *buf,size_t n)
+{
+
+ const unsigned char *b = (const unsigned char *) buf;
+ unsigned char *dst;
+ size_t k;
+
+ while(n){
+   k = n;
+   dst = (unsigned char *) dh_shm_producer_reserve(p,&k);
+   if(dst == NULL) return(-1);
+   memcpy(dst,b,k);
+   dh_shm_producer_commit(p,k);
+   b += k;
+   n -= k;
+ }
+ return(0);
+
+}
+
+void dh_shm_producer_close(dh_shm_producer *p)
+{
+
+ dh_shm_header *h = p->h;
+
+ __atomic_store_n(&h->eof,1,__ATOMIC_RELEASE);
+ __atomic_add_fetch(&h->data_seq,1,__ATOMIC_SEQ_CST);
+ dh_shm_wake(&h->data_seq);
+ munmap(h,p->maplen);
+ shm_unlink(p->name);
+ free(p->name);
+ free(p);
+
+}
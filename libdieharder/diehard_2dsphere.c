@@ -44,32 +44,20 @@
 #define POINTS_2D 8000
 #define DIM_2D 2
 
-typedef struct {
-  double x[DIM_2D];
-} C3_2D;
- 
-int compare_points(const dTuple *a,const dTuple *b);
-double distance(const dTuple a,const dTuple b,uint dim);
-
 int diehard_2dsphere(Test **test, int irun)
 {
 
- int i,j,d,t;
-
- /*
-  * These are the vector of points and the current point being
-  * considered.  We may or may not need to restructure the vectors
-  * to be able to do the sort.  I'm going to TRY to implement
-  * Fischler's suggested algorithm here that is NlogN instead of doing
-  * the straightforward N^2 algorithm, but we'll see.
-  */
- dTuple *points;
- double dist,mindist;
+ int d,t;
+ dh_context *ctx = test[0]->ctx;
 
  /*
-  * for display only.
+  * The points, one vector per coordinate (see dh_mindist2()), which
+  * used to be sorted on the first coordinate and swept for the closest
+  * pair.  dh_mindist2() finds the same pair with a grid of cells, in
+  * time linear in the number of points.
   */
- test[0]->ntuple = ntuple;
+ double *points[DIM_2D];
+ double mindist;
 
  /*
   * Generate d-tuples of tsamples random coordinates in the range 0-10000
@@ -79,7 +67,7 @@ int diehard_2dsphere(Test **test, int irun)
   * independent tests, per dimension.
   */
  test[0]->ntuple = 2;      /* 2 dimensional test, of course */
- points = (dTuple *)malloc(test[0]->tsamples*sizeof(dTuple));
+ for(d=0;d<DIM_2D;d++) points[d] = (double *)malloc(test[0]->tsamples*sizeof(double));
 
 
  if(verbose == D_DIEHARD_2DSPHERE || verbose == D_ALL){
@@ -94,33 +82,9 @@ int diehard_2dsphere(Test **test, int irun)
        printf("points[%u]: (",t);
    }
    for(d=0;d<2;d++) {
-     points[t].c[d] = gsl_rng_uniform_pos(rng)*10000;
+     points[d][t] = gsl_rng_uniform_pos(ctx->rng)*10000;
      if(verbose == D_DIEHARD_2DSPHERE || verbose == D_ALL){
-       printf("%6.4f",points[t].c[d]);
-       if(d == 1){
-         printf(")\n");
-       } else {
-         printf(",");
-       }
-     }
-   }
- }
-
- /*
-  * Now we sort the points using gsl_heapsort and a comparator
-  * on the first coordinate only.  Don't know how to get rid
-  * of the gcc prototype warning.  Probably need a cast of some
-  * sort.
-  */
- gsl_heapsort(points,test[0]->tsamples,sizeof(dTuple),
-                    (gsl_comparison_fn_t) compare_points);
-
- if(verbose == D_DIEHARD_2DSPHERE || verbose == D_ALL){
-   printf("List of points sorted by first coordinate:\n");
-   for(t=0;t<test[0]->tsamples;t++){
-     printf("points[%u]: (",t);
-     for(d=0;d<2;d++) {
-       printf("%6.4f",points[t].c[d]);
+       printf("%6.4f",points[d][t]);
        if(d == 1){
          printf(")\n");
        } else {
@@ -131,27 +95,13 @@ int diehard_2dsphere(Test **test, int irun)
  }
 
  /*
-  * Now we do the SINGLE PASS through to determine mindist
+  * One thing to experiment with here (very much) is whether or not we
+  * need periodic wraparound.  For the moment we omit it, although
+  * distributing the points on a euclidean d-torus seems more symmetric
+  * than not and checks to be sure that points are correct on or very
+  * near a boundary.
   */
- mindist = 10000.0;
- for(i=0;i<test[0]->tsamples;i++){
-   /*
-    * One thing to experiment with here (very much) is
-    * whether or not we need periodic wraparound.  For
-    * the moment we omit it, although distributing
-    * the points on a euclidean d-torus seems more symmetric
-    * than not and checks to be sure that points are correct
-    * on or very near a boundary.
-    */
-   for(j=i+1;j<test[0]->tsamples;j++){
-     if(points[j].c[0] - points[i].c[0] > mindist) break;
-     dist = distance(points[j],points[i],2);
-     MYDEBUG(D_DIEHARD_2DSPHERE) {
-       printf("d(%d,%d) = %16.10e\n",i,j,dist);
-     }
-     if( dist < mindist) mindist = dist;
-   }
- }
+ mindist = sqrt(dh_mindist2(points,test[0]->tsamples,DIM_2D,10000.0));
  MYDEBUG(D_DIEHARD_2DSPHERE) {
    printf("Found minimum distance = %16.10e\n",mindist);
  }
@@ -169,7 +119,7 @@ int diehard_2dsphere(Test **test, int irun)
   */
  test[0]->pvalues[irun] = 1.0 - exp(-mindist*mindist/0.995);
 
- free(points);
+ for(d=0;d<DIM_2D;d++) free(points[d]);
 
  MYDEBUG(D_DIEHARD_2DSPHERE) {
    printf("# diehard_2dsphere(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
@@ -43,18 +43,18 @@
 #define NMS   512
 #define NBITS 24
 
-static double lambda;
-static unsigned int *intervals;
-static unsigned int nms,nbits,kmax;
-
 int diehard_birthdays(Test **test, int irun)
 {
 
  uint i,k,t,m,mnext;
+ uint nms,nbits,kmax;
+ uint *intervals;
+ double lambda;
  uint *js;
  uint rand_uint[NMS];
  
  double binfreq;
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * for display only.  0 means "ignored".
@@ -71,7 +71,7 @@ int diehard_birthdays(Test **test, int irun)
  nms = NMS;
  /* Cruft nbits = diehard_birthdays_nbits; */
  nbits = NBITS;
- if(nbits>rmax_bits) nbits = rmax_bits;
+ if(nbits>ctx->rmax_bits) nbits = ctx->rmax_bits;
 
  /*
   * This is the one thing that matters.  We're going to make the
@@ -128,6 +128,7 @@ int diehard_birthdays(Test **test, int irun)
     * cyclic/periodic bit wrap.
     */
    memset(rand_uint,0,nms*sizeof(uint));
+   dh_rand_bits_reserve(ctx,(off_t) nms*nbits);
    for(m = 0;m<nms;m++){
      /*
       * This tests PRECISELY nbits guaranteed sequential bits from the
@@ -135,7 +136,7 @@ int diehard_birthdays(Test **test, int irun)
       *
       * Note -- removed all reference to overlap.
       */
-     get_rand_bits(&rand_uint[m],sizeof(uint),nbits,rng);
+     get_rand_bits_ctx(&rand_uint[m],sizeof(uint),nbits,ctx);
      MYDEBUG(D_DIEHARD_BDAY){
        printf("  %d-bit int = ",nbits);
        /* Should count dump from the right, sorry */
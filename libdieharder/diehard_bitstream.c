@@ -49,7 +49,7 @@ int diehard_bitstream(Test **test, int irun)
  char *w;
  uint *bitstream,w20,wscratch,newbyte;
  unsigned char *cbitstream = 0;
- uint overlap = 1;  /* Leftovers/Cruft */
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * for display only.  0 means "ignored".
@@ -78,11 +78,12 @@ int diehard_bitstream(Test **test, int irun)
 #define BS_OVERLAP 262146
 #define BS_NO_OVERLAP 1310722
  ptest.y = 141909;
- if(overlap){
+ if(ctx->overlap){
    ptest.sigma = 428.0;
    bitstream = (uint *)malloc(BS_OVERLAP*sizeof(uint));
+   dh_bits_reserve(ctx,(off_t) BS_OVERLAP*32);
    for(i = 0; i < BS_OVERLAP; i++){
-     bitstream[i] = get_rand_bits_uint(32,0xffffffff,rng);
+     bitstream[i] = dh_bits_get32(ctx);
    }
    MYDEBUG(D_DIEHARD_BITSTREAM) {
      printf("# diehard_bitstream: Filled bitstream with %u rands for overlapping\n",BS_OVERLAP);
@@ -91,8 +92,9 @@ int diehard_bitstream(Test **test, int irun)
  } else {
    ptest.sigma = 290.0;
    bitstream = (uint *)malloc(BS_NO_OVERLAP*sizeof(uint));
+   dh_bits_reserve(ctx,(off_t) BS_NO_OVERLAP*32);
    for(i = 0; i < BS_NO_OVERLAP; i++){
-     bitstream[i] = get_rand_bits_uint(32,0xffffffff,rng);
+     bitstream[i] = dh_bits_get32(ctx);
    }
    cbitstream = (unsigned char *)bitstream;   /* To allow us to access it by bytes */
    MYDEBUG(D_DIEHARD_BITSTREAM) {
@@ -121,7 +123,7 @@ int diehard_bitstream(Test **test, int irun)
  wscratch = bitstream[i++];     /* Get initial uint into wscratch */
  for(t=0;t<test[0]->tsamples;t++){
 
-   if(overlap){
+   if(ctx->overlap){
 
      /*
       * We have to slide an overlapping 20-bit window along one bit at a
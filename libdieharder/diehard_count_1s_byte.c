@@ -162,6 +162,7 @@ int diehard_count_1s_byte(Test **test, int irun)
  uint boffset;
  Vtest vtest4,vtest5;
  Xtest ptest;
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * count_1s in specific bytes is straightforward after looking over
@@ -258,6 +259,7 @@ int diehard_count_1s_byte(Test **test, int irun)
   * Here is the test.  We cycle boffset through test[0]->tsamples
   */
  boffset = 0;
+ dh_bits_reserve(ctx,(off_t) test[0]->tsamples*5*32);
  for(t=0;t<test[0]->tsamples;t++){
 
    boffset = t%32;  /* Remember that get_bit_ntuple periodic wraps the uint */
@@ -266,7 +268,7 @@ int diehard_count_1s_byte(Test **test, int irun)
     * overlap.
     */
    for(k=0;k<5;k++){
-     i = get_rand_bits_uint(32, 0xFFFFFFFF, rng);
+     i = dh_bits_get32(ctx);
      if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
        dumpbits(&i,32);
      }
@@ -152,7 +152,7 @@ int diehard_count_1s_stream(Test **test, int irun)
  uint boffset;
  Vtest vtest4,vtest5;
  Xtest ptest;
- uint overlap = 1; /* leftovers/cruft */
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * Count a Stream of 1's is a very complex way of generating a statistic.
@@ -258,8 +258,8 @@ int diehard_count_1s_stream(Test **test, int irun)
   * Preload index with the four bytes of the first rand if overlapping
   * only.
   */
- if(overlap){
-   i = get_rand_bits_uint(32, 0xFFFFFFFF, rng);
+ if(ctx->overlap){
+   i = dh_bits_get32(ctx);
    MYDEBUG(D_DIEHARD_COUNT_1S_STREAM){
      dumpbits(&i,32);
    }
@@ -313,7 +313,7 @@ int diehard_count_1s_stream(Test **test, int irun)
     * where each successive call returns the next morphed index5,
     * overlapping or not.
     */
-   if(overlap){
+   if(ctx->overlap){
      /*
       * Use overlapping bytes to generate the next index5 according to
       * the diehard prescription (designed to work with a very small
@@ -324,7 +324,7 @@ int diehard_count_1s_stream(Test **test, int irun)
         * We need a new rand to get our next byte.
         */
        boffset = 0;
-       i = get_rand_bits_uint(32, 0xFFFFFFFF, rng);
+       i = dh_bits_get32(ctx);
        if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
          dumpbits(&i,32);
        }
@@ -357,7 +357,7 @@ int diehard_count_1s_stream(Test **test, int irun)
 	  * We need a new rand to get our next byte.
 	  */
          boffset = 0;
-         i = get_rand_bits_uint(32, 0xFFFFFFFF, rng);
+         i = dh_bits_get32(ctx);
          if(verbose == D_DIEHARD_COUNT_1S_STREAM || verbose == D_ALL){
            dumpbits(&i,32);
          }
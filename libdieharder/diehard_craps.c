@@ -27,8 +27,8 @@
 
 #include <dieharder/libdieharder.h>
 
-uint roll(){
-  uint d = 1 + gsl_rng_uniform_int(rng,6);
+uint roll(dh_context *ctx){
+  uint d = 1 + gsl_rng_uniform_int(ctx->rng,6);
   return d;
 }
 
@@ -40,6 +40,7 @@ int diehard_craps(Test **test, int irun)
  double sum,p;
  Xtest ptest;
  Vtest vtest;
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * This is just for output display.
@@ -105,7 +106,7 @@ int diehard_craps(Test **test, int irun)
     * This is the point count we have to make, the sum of two rolled
     * dice.
     */
-   point = roll() + roll();
+   point = roll(ctx) + roll(ctx);
    tries = 0;
 
    if(point == 7 || point == 11) {
@@ -132,7 +133,7 @@ int diehard_craps(Test **test, int irun)
 	* then freezes it.
         */
        (tries<20)?tries++:tries;
-       throw = roll() + roll();
+       throw = roll(ctx) + roll(ctx);
        if(throw == 7){
          vtest.x[tries]++;
 	 break;
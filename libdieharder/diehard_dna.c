@@ -36,16 +36,15 @@
 
 
 #include <dieharder/libdieharder.h>
-#include "static_get_bits.c"
-static uint mask;
 
 int diehard_dna(Test **test, int irun)
 {
 
- uint i,j,k,l,m,n,o,p,q,r,t,boffset;
- uint i0,j0,k0,l0,m0,n0,o0,p0,q0,r0;
+ uint m,t,b,boffset,r,word;
+ uint x[10];
+ uint64_t *w;
  Xtest ptest;
- char **********w;
+ dh_context *ctx = test[0]->ctx;
 
  MYDEBUG(D_DIEHARD_DNA){
    fprintf(stdout,"# diehard_dna(): Starting test.\n");
@@ -58,18 +57,10 @@ int diehard_dna(Test **test, int irun)
 
  /*
   * This is pointless, I think, but it shuts -Wall up and is harmless.
+  * (The words are no longer used, but are still drawn so that the test
+  * sees the same rands it always has.)
   */
- i0 = gsl_rng_get(rng);
- j0 = gsl_rng_get(rng);
- k0 = gsl_rng_get(rng);
- l0 = gsl_rng_get(rng);
- m0 = gsl_rng_get(rng);
- n0 = gsl_rng_get(rng);
- o0 = gsl_rng_get(rng);
- p0 = gsl_rng_get(rng);
- q0 = gsl_rng_get(rng);
- r0 = gsl_rng_get(rng);
- boffset = 0;
+ for(m=0;m<10;m++) x[m] = gsl_rng_get(ctx->rng);
 
  /*
   * p = 141909, with sigma 339, FOR tsamples 2^21+1 2 letter words.
@@ -86,118 +77,45 @@ int diehard_dna(Test **test, int irun)
 
  /*
   * We now make tsamples measurements, as usual, to generate the missing
-  * statistic.  Wow!  10 dimensions!  I don't think even my tensor()
-  * package will do that...;-)
+  * statistic.  Wow!  10 dimensions!  The ten 2 bit letters are packed
+  * into a 20 bit word, first letter highest, and marked seen in the
+  * 4^10 = 2^20 bit bitset of missing_words.c.
   */
-
- w = (char **********)malloc(4*sizeof(char *********));
- for(i=0;i<4;i++){
-   w[i] = (char *********)malloc(4*sizeof(char ********));
-   for(j=0;j<4;j++){
-     w[i][j] = (char ********)malloc(4*sizeof(char *******));
-     for(k=0;k<4;k++){
-       w[i][j][k] = (char *******)malloc(4*sizeof(char******));
-       for(l=0;l<4;l++){
-         w[i][j][k][l] = (char ******)malloc(4*sizeof(char*****));
-         for(m=0;m<4;m++){
-           w[i][j][k][l][m] = (char *****)malloc(4*sizeof(char****));
-           for(n=0;n<4;n++){
-             w[i][j][k][l][m][n] = (char ****)malloc(4*sizeof(char***));
-             for(o=0;o<4;o++){
-               w[i][j][k][l][m][n][o] = (char ***)malloc(4*sizeof(char**));
-               for(p=0;p<4;p++){
-                 w[i][j][k][l][m][n][o][p] = (char **)malloc(4*sizeof(char*));
-                 for(q=0;q<4;q++){
-                   w[i][j][k][l][m][n][o][p][q] = (char *)malloc(4*sizeof(char));
-                   /* Zero the column */
-                   memset(w[i][j][k][l][m][n][o][p][q],0,4*sizeof(char));
-		 }
-	       }
-	     }
-	   }
-	 }
-       }
-     }
-   }
- }
+ w = dh_words_clear(ctx);
 
  /*
-  * To minimize the number of rng calls, we use each j and k mod 32
-  * to determine the offset of the 10-bit long string (with
-  * periodic wraparound) to be used for the next iteration.  We
-  * therefore have to "seed" the process with a random l
+  * Again pointless (this "seed" is never used), but drawn all the same.
   */
- q = gsl_rng_get(rng);
- /* mask = ((2 << 1)-1); */
- mask = 0x3;
- for(t=0;t<test[0]->tsamples;t++){
+ (void) gsl_rng_get(ctx->rng);
+ r = ctx->rmax_bits;
+ for(t=0;t<test[0]->tsamples;t+=32){
    /*
-    * Let's do this the cheap/easy way first, sliding a 20 bit
-    * window along each int for the 32 possible starting
+    * Let's do this the cheap/easy way first, sliding a 2 bit
+    * window along each of ten ints for the 32 possible starting
     * positions a la birthdays, before trying to slide it all
     * the way down the whole random bitstring implicit in a
     * long sequence of random ints.  That way we can exit
     * the tsamples loop at tsamples = 2^15...
     */
-   if(t%32 == 0) {
-     i0 = gsl_rng_get(rng);
-     j0 = gsl_rng_get(rng);
-     k0 = gsl_rng_get(rng);
-     l0 = gsl_rng_get(rng);
-     m0 = gsl_rng_get(rng);
-     n0 = gsl_rng_get(rng);
-     o0 = gsl_rng_get(rng);
-     p0 = gsl_rng_get(rng);
-     q0 = gsl_rng_get(rng);
-     r0 = gsl_rng_get(rng);
-     boffset = 0;
+   for(m=0;m<10;m++) x[m] = gsl_rng_get(ctx->rng);
+   for(boffset=0;boffset<32 && t + boffset < test[0]->tsamples;boffset++){
+     /*
+      * Letter m is bits b and b+1 of x[m], wrapping around at the
+      * rmax_bits valid bits (as get_bit_ntuple_from_uint() does).
+      */
+     b = boffset%r;
+     word = 0;
+     for(m=0;m<10;m++){
+       word = word << 2 | (((x[m] >> b) | (x[m] << 1 << (r-1-b))) & 0x3);
+     }
+     DH_WORDS_SET(w,word);
    }
-   /*
-    * Get four "letters" (indices into w)
-    */
-   i = get_bit_ntuple_from_uint(i0,2,mask,boffset);
-   j = get_bit_ntuple_from_uint(j0,2,mask,boffset);
-   k = get_bit_ntuple_from_uint(k0,2,mask,boffset);
-   l = get_bit_ntuple_from_uint(l0,2,mask,boffset);
-   m = get_bit_ntuple_from_uint(m0,2,mask,boffset);
-   n = get_bit_ntuple_from_uint(n0,2,mask,boffset);
-   o = get_bit_ntuple_from_uint(o0,2,mask,boffset);
-   p = get_bit_ntuple_from_uint(p0,2,mask,boffset);
-   q = get_bit_ntuple_from_uint(q0,2,mask,boffset);
-   r = get_bit_ntuple_from_uint(r0,2,mask,boffset);
-   /* printf("%u:   %u  %u  %u  %u  %u\n",t,i,j,k,l,boffset); */
-   w[i][j][k][l][m][n][o][p][q][r]++;
-   boffset++;
  }
 
  /*
   * Now we count the holes, so to speak
   */
- ptest.x = 0;
- for(i=0;i<4;i++){
-   for(j=0;j<4;j++){
-     for(k=0;k<4;k++){
-       for(l=0;l<4;l++){
-         for(m=0;m<4;m++){
-           for(n=0;n<4;n++){
-             for(o=0;o<4;o++){
-               for(p=0;p<4;p++){
-                 for(q=0;q<4;q++){
-                   for(r=0;r<4;r++){
-                     if(w[i][j][k][l][m][n][o][p][q][r] == 0){
-                       ptest.x += 1.0;
-                       /* printf("ptest.x = %f  Hole: w[%u][%u][%u][%u] = %u\n",ptest.x,i,j,k,l,w[i][j][k][l]); */
-		     }
-		   }
-		 }
-	       }
-	     }
-	   }
-	 }
-       }
-     }
-   }
- }
+ ptest.x = dh_words_missing(w);
  MYDEBUG(D_DIEHARD_DNA) {
    printf("%f %f %f\n",ptest.y,ptest.x,ptest.x-ptest.y);
  }
@@ -209,38 +127,6 @@ int diehard_dna(Test **test, int irun)
    printf("# diehard_dna(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
  }
 
- /*
-  * Don't forget to free w when done, in reverse order
-  */
- for(i=0;i<4;i++){
-   for(j=0;j<4;j++){
-     for(k=0;k<4;k++){
-       for(l=0;l<4;l++){
-         for(m=0;m<4;m++){
-           for(n=0;n<4;n++){
-             for(o=0;o<4;o++){
-               for(p=0;p<4;p++){
-                 for(q=0;q<4;q++){
-                   free(w[i][j][k][l][m][n][o][p][q]);
-		 }
-		 free(w[i][j][k][l][m][n][o][p]);
-	       }
-               free(w[i][j][k][l][m][n][o]);
-	     }
-             free(w[i][j][k][l][m][n]);
-	   }
-           free(w[i][j][k][l][m]);
-	 }
-         free(w[i][j][k][l]);
-       }
-       free(w[i][j][k]);
-     }
-     free(w[i][j]);
-   }
-   free(w[i]);
- }
- free(w);
-
  return(0);
 
 }
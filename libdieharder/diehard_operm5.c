@@ -63,9 +63,6 @@
 
 #include <dieharder/libdieharder.h>
 
-static int tflag=0;
-static double tcount[120];
-
 /*
 * kperm computes the permutation number of a vector of five integers
 * passed to it.
@@ -128,26 +125,23 @@ int diehard_operm5(Test **test, int irun)
  uint v[5];
  double count[120];
  double av,norm,x[120],chisq,ndof;
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * Zero count vector, was t(120) in diehard.f90.
   */
  for(i=0;i<120;i++) {
    count[i] = 0.0;
-   if(tflag == 0){
-     tcount[i] = 0.0;
-     tflag = 1;
-   }
  }
 
- if(overlap){
+ if(ctx->overlap){
    for(i=0;i<5;i++){
-     v[i] = gsl_rng_get(rng);
+     v[i] = gsl_rng_get(ctx->rng);
    }
    vind = 0;
  } else {
    for(i=0;i<5;i++){
-     v[i] = gsl_rng_get(rng);
+     v[i] = gsl_rng_get(ctx->rng);
    }
  }
 
@@ -160,25 +154,20 @@ int diehard_operm5(Test **test, int irun)
     * determine whether or not to refill the entire v vector or just
     * rotate bytes.
     */
-  if(overlap){
+  if(ctx->overlap){
     kp = kperm(v,vind);
     count[kp] += 1;
-    v[vind] = gsl_rng_get(rng);
+    v[vind] = gsl_rng_get(ctx->rng);
     vind = (vind+1)%5;
   } else {
     for(i=0;i<5;i++){
-      v[i] = gsl_rng_get(rng);
+      v[i] = gsl_rng_get(ctx->rng);
     }
     kp = kperm(v,0);
     count[kp] += 1;
   }
  }
 
- for(i=0;i<120;i++){
-   tcount[i] += count[i];
-   /* printf("%u: %f\n",i,tcount[i]); */
- }
-
  chisq = 0.0;
  av = test[0]->tsamples/120.0;
  norm = test[0]->tsamples; // this belongs to the pseudoinverse
@@ -189,14 +178,14 @@ int diehard_operm5(Test **test, int irun)
   * equation C*P*C = C
   */
 	
- if(overlap==0){
+ if(ctx->overlap==0){
    norm = av;
  }
  for(i=0;i<120;i++){
    x[i] = count[i] - av;
  }
 
- if(overlap){
+ if(ctx->overlap){
    for(i=0;i<120;i++){
      for(j=0;j<120;j++){
        chisq = chisq + x[i]*pseudoInv[i][j]*x[j];
@@ -204,7 +193,7 @@ int diehard_operm5(Test **test, int irun)
    }
  }
 
- if(overlap==0){
+ if(ctx->overlap==0){
    for(i=0;i<120;i++){
      chisq = chisq + x[i]*x[i];
    }
@@ -228,12 +217,12 @@ int diehard_operm5(Test **test, int irun)
  chisq = fabs(chisq / norm);
 
  ndof = 96; /* the rank of the covariancematrix and the pseudoinverse */
- if(overlap == 0){
+ if(ctx->overlap == 0){
    ndof = 120-1;
  }
 
  MYDEBUG(D_DIEHARD_OPERM5){
-   printf("# diehard_operm5(): chisq[%u] = %10.5f\n",kspi,chisq);
+   printf("# diehard_operm5(): chisq[%u] = %10.5f\n",irun,chisq);
  }
 
  test[0]->pvalues[irun] = gsl_sf_gamma_inc_Q((double)(ndof)/2.0,chisq/2.0);
@@ -242,8 +231,6 @@ int diehard_operm5(Test **test, int irun)
    printf("# diehard_operm5(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
  }
 
- kspi++;
-
  return(0);
 
 }
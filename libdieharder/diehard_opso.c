@@ -42,12 +42,10 @@
 int diehard_opso(Test **test, int irun)
 {
 
- uint j0=0,k0=0,j,k,t;
+ uint j0,k0,t;
+ uint64_t *w;
  Xtest ptest;
- /*
-  * Fixed test size for speed and as per diehard.
-  */
- char w[1024][1024];
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * for display only.  0 means "ignored".
@@ -76,11 +74,11 @@ int diehard_opso(Test **test, int irun)
  
  /*
   * We now make test[0]->tsamples measurements, as usual, to generate the
-  * missing statistic.  The easiest way to proceed, I think, will
-  * be to generate a simple char matrix 1024x1024 in size and empty.
-  * Each pair of "letters" generated become indices, and a (char) 1
-  * is inserted there.  At the end we just loop the matrix and count
-  * the zeros.
+  * missing statistic.  Each pair of "letters" generated is a 20 bit
+  * word, j (the first letter) << 10 | k, and we mark it seen in a
+  * 2^20 bit bitset (the 1024x1024 bitmap of the pairs, row j, column
+  * k -- see missing_words.c).  At the end we just count the bits that
+  * are still zero.
   *
   * Of course doing it THIS way it is pretty obvious that we could,
   * say, display the 2-color 1024x1024 bitmap this represented graphically.
@@ -92,47 +90,27 @@ int diehard_opso(Test **test, int irun)
   * STILL fail the test, I suppose.  Projectively speaking, though,
   * I have some fairly serious doubts about this, though.
   */
+ w = dh_words_clear(ctx);
 
- memset(w,0,sizeof(char)*1024*1024);
-
- k = 0;
- for(t=0;t<test[0]->tsamples;t++){
-   /*
-    * Let's do this the cheap/easy way first, sliding a 20 bit
-    * window along each int for the 32 possible starting
-    * positions a la birthdays, before trying to slide it all
-    * the way down the whole random bitstring implicit in a
-    * long sequence of random ints.  That way we can exit
-    * the test[0]->tsamples loop at test[0]->tsamples = 2^15...
-    */
-   if(t%2 == 0) {
-     j0 = gsl_rng_get(rng);
-     k0 = gsl_rng_get(rng);
-     j = j0 & 0x03ff;
-     k = k0 & 0x03ff;
-   } else {
-      j = (j0 >> 10) & 0x03ff;
-      k = (k0 >> 10) & 0x03ff;
+ /*
+  * Let's do this the cheap/easy way first, taking two pairs out of the
+  * low 20 bits of each two ints, the first from bits 0-9 and the
+  * second from bits 10-19.  That way we can exit the test[0]->tsamples
+  * loop at test[0]->tsamples = 2^15...
+  */
+ for(t=0;t<test[0]->tsamples;t+=2){
+   j0 = gsl_rng_get(ctx->rng);
+   k0 = gsl_rng_get(ctx->rng);
+   DH_WORDS_SET(w,(j0 & 0x03ff) << 10 | (k0 & 0x03ff));
+   if(t + 1 < test[0]->tsamples){
+     DH_WORDS_SET(w,(j0 & 0x0ffc00) | ((k0 >> 10) & 0x03ff));
    }
-   /*
-    * Get two "letters" (indices into w)
-    */
-   /* printf("%u:   %u  %u  %u\n",t,j,k,boffset); */
-   w[j][k] = 1;
  }
- 
+
  /*
   * Now we count the holes, so to speak
   */
- ptest.x = 0;
- for(j=0;j<1024;j++){
-   for(k=0;k<1024;k++){
-     if(w[j][k] == 0){
-       ptest.x += 1.0;
-       /* printf("ptest.x = %f  Hole: w[%u][%u] = %u\n",ptest.x,j,k,w[j][k]); */
-     }
-   }
- }
+ ptest.x = dh_words_missing(w);
  MYDEBUG(D_DIEHARD_OPSO) {
    printf("%f %f %f\n",ptest.y,ptest.x,ptest.x-ptest.y);
  }
@@ -37,9 +37,10 @@
 int diehard_oqso(Test **test, int irun)
 {
 
- uint i,j,k,l,i0=0,j0=0,k0=0,l0=0,t,boffset=0;
+ uint i0,j0,k0,l0,t,boffset;
+ uint64_t *w;
  Xtest ptest;
- char w[32][32][32][32];
+ dh_context *ctx = test[0]->ctx;
 
 
  /*
@@ -63,8 +64,9 @@ int diehard_oqso(Test **test, int irun)
  /*
   * We now make tsamples measurements, as usual, to generate the
   * missing statistic.  We proceed exactly as we did in opso, but
-  * with a 4d 32x32x32x32 matrix and 5 bit indices.  This should
-  * basically be strongly related to a Knuth hyperplane test in
+  * with four 5 bit letters i,j,k,l packed into the 20 bit word
+  * i << 15 | j << 10 | k << 5 | l (a flattened 32x32x32x32 matrix).
+  * This should basically be strongly related to a Knuth hyperplane test in
   * four dimensions.  Equally obviously there is a sequence of
   * tests, all basically identical, that can be done here much
   * as rgb_bitdist tries to do them.  I'll postpone thinking about
@@ -73,52 +75,30 @@ int diehard_oqso(Test **test, int irun)
   * Programming.
   */
 
- memset(w,0,sizeof(char)*32*32*32*32);
+ w = dh_words_clear(ctx);
 
  /*
-  * To minimize the number of rng calls, we use each j and k mod 32
-  * to determine the offset of the 10-bit long string (with
-  * periodic wraparound) to be used for the next iteration.  We
-  * therefore have to "seed" the process with a random l
+  * To minimize the number of rng calls, we take six words out of every
+  * four rands, the letters of each from the same 5 bits of the four,
+  * bits 0-4 first, then 5-9, and so on up to 25-29.
   */
- for(t=0;t<test[0]->tsamples;t++){
-   if(t%6 == 0) {
-     i0 = gsl_rng_get(rng);
-     j0 = gsl_rng_get(rng);
-     k0 = gsl_rng_get(rng);
-     l0 = gsl_rng_get(rng);
-     boffset = 0;
+ for(t=0;t<test[0]->tsamples;t+=6){
+   i0 = gsl_rng_get(ctx->rng);
+   j0 = gsl_rng_get(ctx->rng);
+   k0 = gsl_rng_get(ctx->rng);
+   l0 = gsl_rng_get(ctx->rng);
+   for(boffset=0;boffset<30 && t + boffset/5 < test[0]->tsamples;boffset+=5){
+     DH_WORDS_SET(w,((i0 >> boffset) & 0x01f) << 15 |
+                    ((j0 >> boffset) & 0x01f) << 10 |
+                    ((k0 >> boffset) & 0x01f) << 5 |
+                    ((l0 >> boffset) & 0x01f));
    }
-   /*
-    * Get four "letters" (indices into w)
-    */
-   i = (i0 >> boffset) & 0x01f;
-   j = (j0 >> boffset) & 0x01f;
-   k = (k0 >> boffset) & 0x01f;
-   l = (l0 >> boffset) & 0x01f;
-
-   w[i][j][k][l]=1;
-   boffset+=5;
-
  }
  
  /*
   * Now we count the holes, so to speak
   */
- t = 0;
- for(i=0;i<32;i++){
-   for(j=0;j<32;j++){
-     for(k=0;k<32;k++){
-       for(l=0;l<32;l++){
-         if(w[i][j][k][l] == 0){
-           t++;
-           /* printf("ptest.x = %f  Hole: w[%u][%u][%u][%u] = %u\n",t,i,j,k,l,w[i][j][k][l]); */
-	 }
-       }
-     }
-   }
- }
- ptest.x = t;
+ ptest.x = dh_words_missing(w);
 
  MYDEBUG(D_DIEHARD_OQSO){
    printf("%f %f %f\n",ptest.y,ptest.x,ptest.x-ptest.y);
@@ -72,64 +72,106 @@ typedef struct {
   double y;
 } Cars;
 
+/*
+ * The lots we know the answer for:  -n side parks 1.2*side^2 times on
+ * a side x side lot (the same density of attempts as Marsaglia's 12000
+ * on 100x100), and k should average mean with sigma sigma.  Only the
+ * first line is Marsaglia's (pcg64 gives 3523.3 and 22.1 in 20000
+ * runs); the rest were simulated with this code.
+ */
+static struct {
+  uint side;
+  double mean;
+  double sigma;
+} park_table[] = {
+  { 100,   3523.0,  21.9},   /* Marsaglia */
+  { 200,  14032.8,  43.4},   /* pcg64, 80000 runs */
+  { 400,  56012.2,  86.6},   /* pcg64, 20000 runs */
+  { 800, 223801.1, 171.6},   /* chacha20, 5000 runs */
+  {   0,      0.0,   0.0}
+};
+
 int diehard_parking_lot(Test **test, int irun)
 {
 
  /*
-  * This is the most that could under any circumstances be parked.
+  * The lot is a side x side grid of unit cells, and cell (cx,cy) holds
+  * the number (+1) of the car parked in it, if any.  Two cars in one
+  * cell would have crashed, so there is never more than one, and a car
+  * can only crash into the cars of the 3x3 cells around its own.
   */
- Cars parked[12000];
- uint k,n,i,crashed;
+ Cars *parked;
+ uint *lot;
+ uint side,k,n,i,crashed;
+ int cx,cy,dx,dy;
  double xtry,ytry;
  Xtest ptest;
+ dh_context *ctx = test[0]->ctx;
 
  /*
-  * for display only.  0 means "ignored".
+  * -n picks the lot size; 0 (the default) is Marsaglia's 100x100,
+  * shown as 0 for "ignored" as it always was.
   */
+ side = 100;
  test[0]->ntuple = 0;
- test[0]->tsamples = 12000;
+ ptest.y = park_table[0].mean;
+ ptest.sigma = park_table[0].sigma;
+ if(ctx->ntuple != 0 && ctx->ntuple != 100){
+   for(i=1;park_table[i].side != 0;i++){
+     if(park_table[i].side == ctx->ntuple) break;
+   }
+   if(park_table[i].side != 0){
+     side = park_table[i].side;
+     test[0]->ntuple = side;
+     ptest.y = park_table[i].mean;
+     ptest.sigma = park_table[i].sigma;
+   } else if(irun == 0){
+     fprintf(stderr,"# diehard_parking_lot(): no %ux%u lot (-n 200, 400 or 800), using 100x100\n",
+             ctx->ntuple,ctx->ntuple);
+   }
+ }
+ test[0]->tsamples = 12*side*side/10;
 
  /*
   * ptest.x = (double) k
-  * ptest.y = 3523.0
+  * ptest.y = 3523.0 (for 100x100)
   * ptest.sigma = 21.9
   * This will generate ptest->pvalue when Xtest(ptest) is called
   */
- ptest.y = 3523.0;
- ptest.sigma = 21.9;
-
- /*
-  * Clear the parking lot the fast way.
-  */
- memset(parked,0,12000*sizeof(Cars));
+ parked = (Cars *)malloc(side*side*sizeof(Cars));
+ lot = (uint *)calloc(side*side,sizeof(uint));
 
  /*
   * Park a single car to have something to avoid and count it.
   */
- parked[0].x = 100.0*gsl_rng_uniform(rng);
- parked[0].y = 100.0*gsl_rng_uniform(rng);
+ parked[0].x = side*gsl_rng_uniform(ctx->rng);
+ parked[0].y = side*gsl_rng_uniform(ctx->rng);
+ lot[(uint)parked[0].y*side + (uint)parked[0].x] = 1;
  k = 1;
  
 
  /*
   * This is now a really simple test.  Park them cars!  We try to park
-  * 12000 times, and increment k (the number successfully parked) on
-  * successes.  We brute force the crash test.
+  * tsamples times, and increment k (the number successfully parked) on
+  * successes.  Only the cars in the cells around the try can be hit.
   */
- for(n=1;n<12000;n++){
-   xtry = 100.0*gsl_rng_uniform(rng);
-   ytry = 100.0*gsl_rng_uniform(rng);
+ for(n=1;n<test[0]->tsamples;n++){
+   xtry = side*gsl_rng_uniform(ctx->rng);
+   ytry = side*gsl_rng_uniform(ctx->rng);
+   cx = (int) xtry;
+   cy = (int) ytry;
    crashed = 0;
-   for(i=0;i<k;i++){
-     /*
-      * We do this REASONABLY efficiently.  As soon as we know we didn't
-      * crash we move on until we learn that we crashed, trying to skip
-      * arithmetic.  Once we've crashed, we break out of the loop.
-      * Uncrashed survivors join the parked list.
-      */
-     if( (fabs(parked[i].x - xtry) <= 1.0) && (fabs(parked[i].y - ytry) <= 1.0)){
-       crashed = 1;  /* We crashed! */
-       break;        /* So quit the loop here */
+   for(dy=-1;dy<=1 && !crashed;dy++){
+     if(cy+dy < 0 || cy+dy >= (int) side) continue;
+     for(dx=-1;dx<=1;dx++){
+       if(cx+dx < 0 || cx+dx >= (int) side) continue;
+       i = lot[(cy+dy)*side + cx+dx];
+       if(i == 0) continue;
+       i--;
+       if( (fabs(parked[i].x - xtry) <= 1.0) && (fabs(parked[i].y - ytry) <= 1.0)){
+         crashed = 1;  /* We crashed! */
+         break;        /* So quit the loop here */
+       }
      }
    }
    /*
@@ -138,8 +180,8 @@ int diehard_parking_lot(Test **test, int irun)
    if(crashed == 0){
      parked[k].x = xtry;
      parked[k].y = ytry;
-     crashed = 0;
      k++;
+     lot[cy*side + cx] = k;
    }
  }
 
@@ -148,10 +190,13 @@ int diehard_parking_lot(Test **test, int irun)
  test[0]->pvalues[irun] = ptest.pvalue;
 
  MYDEBUG(D_DIEHARD_PARKING_LOT) {
+   printf("# diehard_parking_lot(): %u cars parked on %ux%u in %u tries\n",k,side,side,test[0]->tsamples);
    printf("# diehard_parking_lot(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
  }
 
+ free(lot);
+ free(parked);
+
  return(0);
 
 }
-
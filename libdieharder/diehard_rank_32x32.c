@@ -29,25 +29,25 @@
  */
 #include "static_get_bits.c"
 
+#define RANK_BATCH 256
+
 int diehard_rank_32x32(Test **test, int irun)
 {
 
- int i,t,rank;
- uint bitstring;
- /* uint mtx[32][1]; */
- uint **mtx;
+ int i,m,nb,t,rank;
+ /*
+  * RANK_BATCH matrices at a time, one uint per row.
+  */
+ uint mtx[RANK_BATCH*32];
+ int ranks[RANK_BATCH];
  Vtest vtest;
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * for display only.  0 means "ignored".
   */
  test[0]->ntuple = 0;
 
- mtx=(uint **)malloc(32*sizeof(uint*));
- for(i=0;i<32;i++){
-   mtx[i] = (uint*)malloc(sizeof(uint));
- }
-
  MYDEBUG(D_DIEHARD_RANK_32x32){
    fprintf(stdout,"# diehard_rank_32x32(): Starting test\n");
  }
@@ -80,39 +80,34 @@ int diehard_rank_32x32(Test **test, int irun)
  vtest.x[32] = 0.0;
  vtest.y[32] = test[0]->tsamples*0.2887880952e+00;
 
- for(t=0;t<test[0]->tsamples;t++) {
+ dh_bits_reserve(ctx,(off_t) test[0]->tsamples*32*32);
+ for(t=0;t<test[0]->tsamples;t+=nb) {
 
-   MYDEBUG(D_DIEHARD_RANK_32x32){
-     fprintf(stdout,"# diehard_rank_32x32(): Input random matrix = \n");
+   nb = test[0]->tsamples - t;
+   if(nb > RANK_BATCH) nb = RANK_BATCH;
+   for(i=0;i<nb*32;i++){
+     mtx[i] = dh_bits_get32(ctx);
    }
+   binary_rank_batch(mtx,32,32,nb,ranks);
 
-   for(i=0;i<32;i++){
+   for(m=0;m<nb;m++){
+     rank = ranks[m];
      MYDEBUG(D_DIEHARD_RANK_32x32){
-       fprintf(stdout,"# ");
+       fprintf(stdout,"# diehard_rank_32x32(): Input random matrix = \n");
+       for(i=0;i<32;i++){
+         fprintf(stdout,"# ");
+         dumpbits(&mtx[m*32+i],32);
+         fprintf(stdout,"\n");
+       }
+       fprintf(stdout,"# binary rank = %d\n",rank);
      }
 
-     bitstring = get_rand_bits_uint(32,0xffffffff,rng);
-     mtx[i][0] = bitstring;
-
-     MYDEBUG(D_DIEHARD_RANK_32x32){
-       dumpbits(mtx[i],32);
-       fprintf(stdout,"\n");
+     if(rank <= 29){
+       vtest.x[29]++;
+     } else {
+       vtest.x[rank]++;
      }
    }
-
-   /*
-    * This is a silly thing to quiet gcc complaints about twin puns.
-    */
-   rank = binary_rank(mtx,32,32);
-   MYDEBUG(D_DIEHARD_RANK_32x32){
-     fprintf(stdout,"# binary rank = %d\n",rank);
-   }
-
-   if(rank <= 29){
-     vtest.x[29]++;
-   } else {
-     vtest.x[rank]++;
-   }
  }
 
  /* for(i=0;i<33;i++) printf("vtest.x[%d] =  %f\n",i,vtest.x[i]); */
@@ -125,11 +120,6 @@ int diehard_rank_32x32(Test **test, int irun)
 
  Vtest_destroy(&vtest);
 
- for(i=0;i<32;i++){
-   free(mtx[i]);
- }
- free(mtx);
-
  return(0);
 
 }
@@ -30,14 +30,20 @@
  */
 #include "static_get_bits.c"
 
+#define RANK_BATCH 256
+
 int diehard_rank_6x8(Test **test, int irun)
 {
 
 
- int i,t,rank;
- uint bitstring;
- uint **mtx;
+ int i,m,nb,t,rank;
+ /*
+  * RANK_BATCH matrices at a time, one uint per row.
+  */
+ uint mtx[RANK_BATCH*6];
+ int ranks[RANK_BATCH];
  Vtest vtest;
+ dh_context *ctx = test[0]->ctx;
 
  MYDEBUG(D_DIEHARD_RANK_6x8){
    fprintf(stdout,"# diehard_rank_6x8():  Starting test.\n");
@@ -48,11 +54,6 @@ int diehard_rank_6x8(Test **test, int irun)
   */
  test[0]->ntuple = 0;
 
- mtx = (uint **)malloc(6*sizeof(uint *));
- for(i=0;i<6;i++){
-   mtx[i] = (uint *)malloc(8*sizeof(uint));
- }
-
  Vtest_create(&vtest,7);
  vtest.cutoff = 5.0;
  for(i=0;i<2;i++){
@@ -70,39 +71,37 @@ int diehard_rank_6x8(Test **test, int irun)
  vtest.x[6] = 0.0;
  vtest.y[6] = test[0]->tsamples*0.773118E+00;
 
- for(t=0;t<test[0]->tsamples;t++){
+ dh_bits_reserve(ctx,(off_t) test[0]->tsamples*6*32);
+ for(t=0;t<test[0]->tsamples;t+=nb){
 
    /*
-    * We generate 6 random rmax_bits-bit integers and put a
-    * randomly chosen byte into the LEFTMOST byte position
-    * of the row/slot of mtx.
+    * We generate 6 random rmax_bits-bit integers per matrix, and its
+    * rows are their low bytes.
     */
-   MYDEBUG(D_DIEHARD_RANK_6x8){
-     fprintf(stdout,"# diehard_rank_6x8(): Input random matrix = \n");
+   nb = test[0]->tsamples - t;
+   if(nb > RANK_BATCH) nb = RANK_BATCH;
+   for(i=0;i<nb*6;i++){
+     mtx[i] = dh_bits_get32(ctx);
    }
-   for(i=0;i<6;i++){
-     MYDEBUG(D_DIEHARD_RANK_6x8){
-       fprintf(stdout,"# ");
-     }
-
-     bitstring = get_rand_bits_uint(32,0xffffffff,rng);
-     mtx[i][0] = bitstring;
+   binary_rank_batch(mtx,6,8,nb,ranks);
 
+   for(m=0;m<nb;m++){
+     rank = ranks[m];
      MYDEBUG(D_DIEHARD_RANK_6x8){
-       dumpbits(mtx[i],32);
-       fprintf(stdout,"\n");
+       fprintf(stdout,"# diehard_rank_6x8(): Input random matrix = \n");
+       for(i=0;i<6;i++){
+         fprintf(stdout,"# ");
+         dumpbits(&mtx[m*6+i],32);
+         fprintf(stdout,"\n");
+       }
+       printf("binary rank = %d\n",rank);
      }
-   }
-
-   rank = binary_rank(mtx,6,8);
-   MYDEBUG(D_DIEHARD_RANK_6x8){
-     printf("binary rank = %d\n",rank);
-   }
 
-   if(rank <= 2){
-     vtest.x[2]++;
-   } else {
-     vtest.x[rank]++;
+     if(rank <= 2){
+       vtest.x[2]++;
+     } else {
+       vtest.x[rank]++;
+     }
    }
  }
 
@@ -116,11 +115,6 @@ int diehard_rank_6x8(Test **test, int irun)
 
  Vtest_destroy(&vtest);
 
- for(i=0;i<6;i++){
-   free(mtx[i]);
- }
- free(mtx);
-
  return(0);
 
 }
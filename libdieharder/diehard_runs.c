@@ -82,6 +82,9 @@ int diehard_runs(Test **test, int irun)
  int upruns[RUN_MAX],downruns[RUN_MAX];
  double uv,dv,up_pks,dn_pks;
  uint first, last, next = 0;
+ uint buf[DH_FILL_BLOCK];
+ uint nbuf = 0, ibuf = 0;
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * This is just for display.
@@ -106,9 +109,15 @@ int diehard_runs(Test **test, int irun)
  if(verbose){
    printf("j    rand    ucount  dcount\n");
  }
- first = last = gsl_rng_get(rng);
+ first = last = gsl_rng_get(ctx->rng);
  for(t=1;t<test[0]->tsamples;t++) {
-   next = gsl_rng_get(rng);
+   if(ibuf == nbuf){
+     nbuf = test[0]->tsamples - t;
+     if(nbuf > DH_FILL_BLOCK) nbuf = DH_FILL_BLOCK;
+     dh_rng_fill(ctx->rng,buf,nbuf);
+     ibuf = 0;
+   }
+   next = buf[ibuf++];
    if(verbose){
      printf("%d:  %10u   %u    %u\n",t,next,ucount,dcount);
    }
@@ -100,10 +100,78 @@ void dieharder_rng_types()
  dh_num_dieharder_rngs++;
  ADD(gsl_rng_superkiss);
  dh_num_dieharder_rngs++;
+ ADD(gsl_rng_xoshiro256ss);
+ dh_num_dieharder_rngs++;
+ ADD(gsl_rng_xoroshiro128p);
+ dh_num_dieharder_rngs++;
+ ADD(gsl_rng_pcg64);
+ dh_num_dieharder_rngs++;
+ ADD(gsl_rng_splitmix64);
+ dh_num_dieharder_rngs++;
+ ADD(gsl_rng_philox4x32);
+ dh_num_dieharder_rngs++;
+ ADD(gsl_rng_chacha20);
+ dh_num_dieharder_rngs++;
+ ADD(gsl_rng_stdin_input_raw64);
+ dh_num_dieharder_rngs++;
+ ADD(gsl_rng_file_input_raw64);
+ dh_num_dieharder_rngs++;
+ ADD(gsl_rng_shm_input);
+ dh_num_dieharder_rngs++;
  MYDEBUG(D_TYPES){
    printf("# startup:  Found %u dieharder rngs.\n",dh_num_dieharder_rngs);
  }
 
+ /*
+  * Register the native bulk fill routines of the dieharder generators
+  * (see dh_rng_fill()).  Everybody else is filled one gsl_rng_get() at
+  * a time.
+  */
+ FILL(gsl_rng_stdin_input_raw,stdin_input_raw_fill);
+ FILL(gsl_rng_file_input_raw,file_input_raw_fill);
+ FILL(gsl_rng_stdin_input_raw64,stdin_input_raw_fill);
+ FILL(gsl_rng_file_input_raw64,file_input_raw_fill);
+ FILL(gsl_rng_file_input,file_input_fill);
+ FILL(gsl_rng_shm_input,shm_input_fill);
+ FILL(gsl_rng_ca,ca_fill);
+ FILL(gsl_rng_uvag,uvag_fill);
+ FILL(gsl_rng_aes,aes_fill);
+ FILL(gsl_rng_threefish,threefish_fill);
+ FILL(gsl_rng_kiss,kiss_fill);
+ FILL(gsl_rng_superkiss,superkiss_fill);
+ FILL(gsl_rng_XOR,XOR_fill);
+ FILL(gsl_rng_xoshiro256ss,xoshiro256ss_fill);
+ FILL(gsl_rng_xoroshiro128p,xoroshiro128p_fill);
+ FILL(gsl_rng_pcg64,pcg64_fill);
+ FILL(gsl_rng_splitmix64,splitmix64_fill);
+ FILL(gsl_rng_philox4x32,philox4x32_fill);
+ FILL(gsl_rng_chacha20,chacha20_fill);
+ FILL(gsl_rng_getrandom,getrandom_fill);
+ FILL(gsl_rng_getrandom_prefetch,getrandom_prefetch_fill);
+
+ /*
+  * ...and the 64 bit fills of those that make 64 bit words.
+  */
+ FILL64(gsl_rng_stdin_input_raw64,stdin_input_raw64_fill64);
+ FILL64(gsl_rng_file_input_raw64,file_input_raw64_fill64);
+ FILL64(gsl_rng_shm_input,shm_input_fill64);
+ FILL64(gsl_rng_threefish,threefish_fill64);
+ FILL64(gsl_rng_xoshiro256ss,xoshiro256ss_fill64);
+ FILL64(gsl_rng_xoroshiro128p,xoroshiro128p_fill64);
+ FILL64(gsl_rng_pcg64,pcg64_fill64);
+ FILL64(gsl_rng_splitmix64,splitmix64_fill64);
+
+ /*
+  * ...and the substream routines of those that have them (see
+  * dh_rng_substream()).
+  */
+ SUBSTREAM(gsl_rng_xoshiro256ss,xoshiro256ss_substream);
+ SUBSTREAM(gsl_rng_xoroshiro128p,xoroshiro128p_substream);
+ SUBSTREAM(gsl_rng_pcg64,pcg64_substream);
+ SUBSTREAM(gsl_rng_splitmix64,splitmix64_substream);
+ SUBSTREAM(gsl_rng_philox4x32,philox4x32_substream);
+ SUBSTREAM(gsl_rng_chacha20,chacha20_substream);
+
 
  /*
   * These are the R-based generators.  Honestly it would be lovely
@@ -151,6 +219,12 @@ void dieharder_rng_types()
    fclose(test_fp);
    dh_num_hardware_rngs++;
  }
+ if (getrandom_available()) {
+   ADD(gsl_rng_getrandom);
+   dh_num_hardware_rngs++;
+   ADD(gsl_rng_getrandom_prefetch);
+   dh_num_hardware_rngs++;
+ }
  MYDEBUG(D_TYPES){
    printf("# startup:  Found %u hardware rngs.\n",dh_num_hardware_rngs);
  }
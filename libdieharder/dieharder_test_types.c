@@ -156,6 +156,12 @@ void dieharder_test_types()
  ADD_TEST(&dab_opso2_dtest);
  dh_num_other_tests++;
 
+ ADD_TEST(&rgb_binary_rank_dtest);
+ dh_num_other_tests++;
+
+ ADD_TEST(&rgb_bitdist_all_dtest);
+ dh_num_other_tests++;
+
 
  /*
   * This is the total number of DOCUMENTED tests reported back to the
@@ -150,10 +150,11 @@ int marsaglia_tsang_gcd(Test **test, int irun)
 
  unsigned long long int t,ktbl[KTBLSIZE];
  uint i,j,k,u,v,w;
- static uint *gcd = 0;
- static double gnorm = 6.0/(PI*PI);
- static uint gtblsize = 0;
+ uint *gcd;
+ double gnorm = 6.0/(PI*PI);
+ uint gtblsize;
  Vtest vtest_k,vtest_u;
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * For output only
@@ -180,14 +181,12 @@ int marsaglia_tsang_gcd(Test **test, int irun)
 
  /*
   * Zero both tables, set gtblsize so that the expectation of gcd[] > 10
-  * (arbitrary cutoff).  We don't free this on exit, but then, we only
-  * allocate it once so it should be OK.
+  * (arbitrary cutoff).  gcd[] lives in the context workspace, so every
+  * call (and every thread of a -j run) counts into its own table.
   */
- if(gtblsize == 0) {
-   gtblsize = sqrt((double)test[0]->tsamples*gnorm/100.0);
-   /* printf("gtblsize = %u\n",gtblsize); */
- }
- if(gcd == 0) gcd = (uint *)malloc(gtblsize*sizeof(uint));
+ gtblsize = sqrt((double)test[0]->tsamples*gnorm/100.0);
+ /* printf("gtblsize = %u\n",gtblsize); */
+ gcd = (uint *) dh_context_workspace(ctx,gtblsize*sizeof(uint));
  memset(gcd,0,gtblsize*sizeof(uint));
  memset(ktbl,0,KTBLSIZE*sizeof(unsigned long long int));
 
@@ -207,10 +206,10 @@ int marsaglia_tsang_gcd(Test **test, int irun)
    k = 0;
    /* Get nonzero u,v */
    do{
-    u = get_rand_bits_uint(32,0xffffffff,rng);
+    u = dh_bits_get32(ctx);
    } while(u == 0);
    do{
-    v = get_rand_bits_uint(32,0xffffffff,rng);
+    v = dh_bits_get32(ctx);
    } while(v == 0);
 
    do{
@@ -325,11 +324,9 @@ int marsaglia_tsang_gcd(Test **test, int irun)
  Vtest_destroy(&vtest_u);
 
  MYDEBUG(D_MARSAGLIA_TSANG_GCD){
-   printf("# marsaglia_tsang_gcd(): ks_pvalue_k[%u] = %10.5f  ks_pvalue_w[%u] = %10.5f\n",kspi,ks_pvalue[kspi],kspi,ks_pvalue2[kspi]);
+   printf("# marsaglia_tsang_gcd(): pvalue_k[%u] = %10.5f  pvalue_u[%u] = %10.5f\n",irun,test[0]->pvalues[irun],irun,test[1]->pvalues[irun]);
  }
 
- kspi++;
-
  return(0);
 
 }
@@ -0,0 +1,276 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * dh_mindist2() is the nearest neighbor engine of the minimum distance
+ * tests (rgb_minimum_distance, diehard_2dsphere and diehard_3dsphere).
+ * It returns the smallest squared distance between any two of the n
+ * points in the cube [0,side)^dim (dim <= RGB_MINIMUM_DISTANCE_MAXDIM)
+ * whose coordinates are x[0][i],...,x[dim-1][i] -- one array per
+ * coordinate, so that the distance kernels below can take the
+ * coordinates of several points at a time.
+ *
+ * The cube is cut into a grid of g^dim cells, about two points to a
+ * cell, and the points are counting-sorted by cell (first coordinate
+ * fastest) into a private copy.  Then any two points closer than a cell
+ * side are in the same or neighboring cells, and the neighboring cells
+ * of a row of cells along the first coordinate hold a contiguous run of
+ * the sorted points.  So each point is only compared to the points after
+ * it up to the end of the next cell of its own row, and to the three
+ * cells around it in each of the neighboring rows "after" its own (half
+ * of them, so that every pair is looked at once), a run at a time.  If
+ * the closest pair found is further apart than a cell side (no bad
+ * generator should be able to pull that off, but) the grid is made
+ * coarse enough and we go again, so the answer is always exact and the
+ * same as the one the double loop over all pairs would give.
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+#define MD_MAXDIM RGB_MINIMUM_DISTANCE_MAXDIM
+
+#if defined(__GNUC__)
+#define MD_WAYS 4
+typedef double md_vec __attribute__ ((vector_size (MD_WAYS*8),aligned (8),__may_alias__));
+typedef long long md_mask __attribute__ ((vector_size (MD_WAYS*8),aligned (8),__may_alias__));
+#endif
+
+/*
+ * The smallest of m and the squared distances from p to the points lo
+ * to hi-1 of y, MD_WAYS points at a time, specialized for 2 and 3
+ * dimensions.  The squares are summed in coordinate order, as in
+ * distance().
+ */
+static inline double md_run2(double *const *y,const double *p,size_t lo,size_t hi,double m)
+{
+
+ size_t j = lo;
+ double d0,d1,r;
+
+#if defined(__GNUC__)
+ if(hi - lo >= MD_WAYS){
+   md_vec vm = {m,m,m,m},vd,vr;
+   md_mask k;
+   int w;
+   for(;j + MD_WAYS <= hi;j += MD_WAYS){
+     vd = *(const md_vec *)(y[0] + j) - p[0];
+     vr = vd*vd;
+     vd = *(const md_vec *)(y[1] + j) - p[1];
+     vr += vd*vd;
+     k = vr < vm;
+     vm = (md_vec)(((md_mask) vr & k) | ((md_mask) vm & ~k));
+   }
+   for(w = 0;w < MD_WAYS;w++) if(vm[w] < m) m = vm[w];
+ }
+#endif
+ for(;j < hi;j++){
+   d0 = y[0][j] - p[0];
+   d1 = y[1][j] - p[1];
+   r = d0*d0 + d1*d1;
+   if(r < m) m = r;
+ }
+ return(m);
+
+}
+
+static inline double md_run3(double *const *y,const double *p,size_t lo,size_t hi,double m)
+{
+
+ size_t j = lo;
+ double d0,d1,d2,r;
+
+#if defined(__GNUC__)
+ if(hi - lo >= MD_WAYS){
+   md_vec vm = {m,m,m,m},vd,vr;
+   md_mask k;
+   int w;
+   for(;j + MD_WAYS <= hi;j += MD_WAYS){
+     vd = *(const md_vec *)(y[0] + j) - p[0];
+     vr = vd*vd;
+     vd = *(const md_vec *)(y[1] + j) - p[1];
+     vr += vd*vd;
+     vd = *(const md_vec *)(y[2] + j) - p[2];
+     vr += vd*vd;
+     k = vr < vm;
+     vm = (md_vec)(((md_mask) vr & k) | ((md_mask) vm & ~k));
+   }
+   for(w = 0;w < MD_WAYS;w++) if(vm[w] < m) m = vm[w];
+ }
+#endif
+ for(;j < hi;j++){
+   d0 = y[0][j] - p[0];
+   d1 = y[1][j] - p[1];
+   d2 = y[2][j] - p[2];
+   r = d0*d0 + d1*d1 + d2*d2;
+   if(r < m) m = r;
+ }
+ return(m);
+
+}
+
+static double md_run(double *const *y,const double *p,unsigned int dim,size_t lo,size_t hi,double m)
+{
+
+ size_t j;
+ unsigned int d;
+ double delta,r;
+
+ switch(dim){
+   case 2:
+     return(md_run2(y,p,lo,hi,m));
+   case 3:
+     return(md_run3(y,p,lo,hi,m));
+ }
+ for(j = lo;j < hi;j++){
+   r = 0.0;
+   for(d = 0;d < dim;d++){
+     delta = y[d][j] - p[d];
+     r += delta*delta;
+   }
+   if(r < m) m = r;
+ }
+ return(m);
+
+}
+
+/*
+ * One pass over a g^dim grid.
+ */
+static double md_grid(double *const *x,size_t n,unsigned int dim,double side,size_t g)
+{
+
+ size_t i,c,ncells,lo,hi,row,stride[MD_MAXDIM+1];
+ size_t *start;
+ double *y[MD_MAXDIM],p[MD_MAXDIM];
+ double h,m;
+ unsigned int d,k,nrow,nfwd;
+ long cc[MD_MAXDIM],off[MD_MAXDIM],o;
+ long fwd[40][MD_MAXDIM];      /* (3^(MD_MAXDIM-1) - 1)/2 neighbor rows */
+ int ok;
+
+ stride[0] = 1;
+ for(d = 0;d < dim;d++) stride[d+1] = stride[d]*g;
+ ncells = stride[dim];
+ h = side/g;
+
+ /*
+  * The neighboring rows after ours:  the offsets in {-1,0,1} of
+  * coordinates 1..dim-1, read as a base 3 number, past the middle.
+  */
+ nrow = 1;
+ for(d = 1;d < dim;d++) nrow *= 3;
+ nfwd = 0;
+ for(k = nrow/2 + 1;k < nrow;k++){
+   o = k;
+   for(d = 1;d < dim;d++){
+     fwd[nfwd][d] = o%3 - 1;
+     o /= 3;
+   }
+   nfwd++;
+ }
+
+ /*
+  * Counting sort of the points by cell.  cc[0] is used for the cell
+  * of point i while counting.
+  */
+ start = (size_t *) calloc(ncells + 1,sizeof(size_t));
+ for(d = 0;d < dim;d++) y[d] = (double *) malloc(n*sizeof(double));
+ for(i = 0;i < n;i++){
+   c = 0;
+   for(d = 0;d < dim;d++){
+     cc[0] = (long)(x[d][i]/h);
+     if(cc[0] >= (long) g) cc[0] = g - 1;
+     if(cc[0] < 0) cc[0] = 0;
+     c += cc[0]*stride[d];
+   }
+   start[c+1]++;
+ }
+ for(c = 0;c < ncells;c++) start[c+1] += start[c];
+ for(i = 0;i < n;i++){
+   c = 0;
+   for(d = 0;d < dim;d++){
+     cc[0] = (long)(x[d][i]/h);
+     if(cc[0] >= (long) g) cc[0] = g - 1;
+     if(cc[0] < 0) cc[0] = 0;
+     c += cc[0]*stride[d];
+   }
+   /* start[c] runs ahead here, and is put back below */
+   for(d = 0;d < dim;d++) y[d][start[c]] = x[d][i];
+   start[c]++;
+ }
+ for(c = ncells;c > 0;c--) start[c] = start[c-1];
+ start[0] = 0;
+
+ m = HUGE_VAL;
+ for(c = 0;c < ncells;c++){
+   if(start[c] == start[c+1]) continue;
+   for(d = 0;d < dim;d++) cc[d] = (c/stride[d])%g;
+   for(i = start[c];i < start[c+1];i++){
+     for(d = 0;d < dim;d++) p[d] = y[d][i];
+
+     /*
+      * The rest of this cell and the next one along the row...
+      */
+     hi = (cc[0] + 1 < (long) g) ? start[c+2] : start[c+1];
+     m = md_run(y,p,dim,i + 1,hi,m);
+
+     /*
+      * ...and three cells of each neighboring row after ours.
+      */
+     for(k = 0;k < nfwd;k++){
+       ok = 1;
+       row = 0;
+       for(d = 1;d < dim;d++){
+         off[d] = cc[d] + fwd[k][d];
+         if(off[d] < 0 || off[d] >= (long) g) ok = 0;
+         row += off[d]*stride[d];
+       }
+       if(!ok) continue;
+       lo = start[row + (cc[0] > 0 ? cc[0] - 1 : 0)];
+       hi = start[row + (cc[0] + 1 < (long) g ? cc[0] + 2 : cc[0] + 1)];
+       m = md_run(y,p,dim,lo,hi,m);
+     }
+   }
+ }
+
+ for(d = 0;d < dim;d++) free(y[d]);
+ free(start);
+
+ return(m);
+
+}
+
+double dh_mindist2(double *const *x,size_t n,unsigned int dim,double side)
+{
+
+ size_t g;
+ double m,h;
+
+ /*
+  * About two points to a cell to start with.
+  */
+ g = (size_t) pow(n/2.0,1.0/dim);
+ if(g < 1) g = 1;
+ while(1){
+   m = md_grid(x,n,dim,side,g);
+   h = side/g;
+   if(g == 1 || m <= h*h) break;
+   MYDEBUG(D_RGB_MINIMUM_DISTANCE){
+     printf("# dh_mindist2(): closest pair %g is more than a cell apart, regridding\n",sqrt(m));
+   }
+   if(m == HUGE_VAL){
+     g /= 2;
+   } else {
+     g = (size_t)(side/sqrt(m));
+   }
+   if(g < 1) g = 1;
+ }
+
+ return(m);
+
+}
@@ -0,0 +1,58 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * The "missing words" engine shared by diehard_opso, diehard_oqso and
+ * diehard_dna.  Each of them draws 2^21 words of 20 bits (two 10 bit
+ * letters, four 5 bit letters or ten 2 bit letters, packed first letter
+ * highest) and counts the 20 bit words that never turn up.  The words
+ * seen are kept as a flat bitset of 2^20 bits (128 KB), set with
+ * DH_WORDS_SET(), and the missing ones are counted a 64 bit word at a
+ * time with popcount.  The bitset lives in the context workspace, so it
+ * is allocated once per context rather than once per psample, and each
+ * thread of a -j run has its own.
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+/*
+ * A cleared bitset of DH_WORDS bits, belonging to ctx.
+ */
+uint64_t *dh_words_clear(dh_context *ctx)
+{
+
+ uint64_t *w;
+
+ w = (uint64_t *) dh_context_workspace(ctx,DH_WORDS/8);
+ memset(w,0,DH_WORDS/8);
+ return(w);
+
+}
+
+/*
+ * The number of bits of w that were never set.
+ */
+uint dh_words_missing(const uint64_t *w)
+{
+
+ uint i,seen = 0;
+
+ for(i = 0;i < DH_WORDS/64;i++){
+#if defined(__GNUC__)
+   seen += __builtin_popcountll(w[i]);
+#else
+   uint64_t x = w[i];
+   x = x - ((x >> 1) & 0x5555555555555555ULL);
+   x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+   x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+   seen += (uint)((x*0x0101010101010101ULL) >> 56);
+#endif
+ }
+ return(DH_WORDS - seen);
+
+}
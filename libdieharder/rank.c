@@ -161,14 +161,14 @@ int binary_rank(uint **mtx,int mrows,int ncols)
           * we use exclusive or to eliminate the
           * rest of the column.
           */
-         n = uint_col_max - col_ind;
+         n = uint_col_max;
          if(verbose == D_BRANK || verbose == D_ALL){
            printf("eliminating against row %2d = ",i);
            dumpbits(&mtx[i][col_ind],32);
            printf("eliminating row %2d, before = ",k);
            dumpbits(&mtx[k][col_ind],32);
          }
-         while (n >= 0){
+         while (n >= col_ind){
            if(verbose == D_BRANK || verbose == D_ALL){
              printf("xoring column = %2d\n",n);
 	   }
@@ -201,3 +201,168 @@ int binary_rank(uint **mtx,int mrows,int ncols)
 
 }
 
+
+/*
+ *========================================================================
+ * The routines below do the same job a whole machine word at a time and
+ * without the row pointers.
+ *
+ * binary_rank_batch() finds the ranks of nmat small matrices at once,
+ * each mrows rows of (the low) ncols <= 32 bits, one uint per row and
+ * the matrices one after the other in mtx.  Each row is reduced against
+ * the rows kept so far, indexed by their lowest set bit:  xoring in the
+ * kept row with the same lowest bit clears that bit and only touches
+ * higher ones, so a row either ends up zero (it depends on the others)
+ * or with a lowest bit nobody has yet, and is kept.  The number kept is
+ * the rank, and mtx is not changed.
+ *========================================================================
+ */
+void binary_rank_batch(const uint *mtx,int mrows,int ncols,int nmat,int *ranks)
+{
+
+ int i,m,r,p;
+ uint v,colmask,pivot[32];
+
+ colmask = (ncols >= 32) ? 0xffffffff : ((1u << ncols) - 1);
+
+ for(m = 0;m < nmat;m++){
+   memset(pivot,0,sizeof(pivot));
+   r = 0;
+   for(i = 0;i < mrows;i++){
+     v = mtx[i] & colmask;
+     while(v){
+       p = __builtin_ctz(v);
+       if(pivot[p] == 0){
+         pivot[p] = v;
+         r++;
+         break;
+       }
+       v ^= pivot[p];
+     }
+   }
+   ranks[m] = r;
+   mtx += mrows;
+ }
+
+}
+
+/*
+ *========================================================================
+ * binary_rank64() is the rank of a big matrix of mrows rows of ncols
+ * bits, stored as one contiguous block of (ncols+63)/64 uint64_t's per
+ * row, bit j of a row being bit j%64 of its word j/64 (as in
+ * binary_rank()).  mtx is destroyed.
+ *
+ * This is gauss elimination done with whole-word xors, eight columns
+ * at a time ("the method of four russians"):  the up to eight pivots of
+ * a block of columns are found and reduced against each other, which
+ * only takes looking at the block's byte of the rows below, then all
+ * the sums of the pivot rows are tabulated, and each row below is then
+ * cleared of the whole block with ONE xor of the table entry that its
+ * byte picks out, instead of one per pivot.  Everything to the left of
+ * the block is already zero below the pivots, so rows are only xor'd
+ * from the block's word on.
+ *========================================================================
+ */
+int binary_rank64(uint64_t *mtx,int mrows,int ncols)
+{
+
+ int i,j,k,n,nw,w,sh,b,np;
+ unsigned int v,s,pmask,pbyte[8];
+ int prow[8];
+ uint64_t tmp;
+ uint64_t *piv,*row,*table,*tent;
+
+ nw = (ncols + 63)/64;
+ table = (uint64_t *) malloc((size_t) 256*nw*sizeof(uint64_t));
+
+ i = 0;
+ for(j = 0;j < ncols && i < mrows;j += 8){
+   w = j/64;
+   sh = j%64;
+
+   /*
+    * Find the block's pivots.  pbyte[b] is the block byte of the pivot
+    * of column j+b (bit b) as reduced so far, so a row's byte can be
+    * reduced without touching the row itself.
+    */
+   np = 0;
+   pmask = 0;
+   for(b = 0;b < 8 && j + b < ncols && i + np < mrows;b++){
+     for(k = i + np;k < mrows;k++){
+       v = (mtx[(size_t) k*nw + w] >> sh) & 0xff;
+       for(n = 0;n < np;n++){
+         if(v & (1u << prow[n])) v ^= pbyte[prow[n]];
+       }
+       if(v & (1u << b)) break;
+     }
+     if(k == mrows) continue;
+
+     /*
+      * Swap row k up to i + np, reduce it against the pivots before it
+      * and them against it, so that every pivot row has a single one
+      * in the pivot columns.
+      */
+     piv = mtx + (size_t)(i + np)*nw;
+     row = mtx + (size_t) k*nw;
+     if(k != i + np){
+       for(n = w;n < nw;n++){
+         tmp = piv[n];
+         piv[n] = row[n];
+         row[n] = tmp;
+       }
+     }
+     for(n = 0;n < np;n++){
+       if((piv[w] >> sh) & (1u << prow[n])){
+         row = mtx + (size_t)(i + n)*nw;
+         for(k = w;k < nw;k++) piv[k] ^= row[k];
+       }
+     }
+     for(n = 0;n < np;n++){
+       row = mtx + (size_t)(i + n)*nw;
+       if((row[w] >> sh) & (1u << b)){
+         for(k = w;k < nw;k++) row[k] ^= piv[k];
+         pbyte[prow[n]] = (row[w] >> sh) & 0xff;
+       }
+     }
+     pbyte[b] = (piv[w] >> sh) & 0xff;
+     prow[np++] = b;
+     pmask |= 1u << b;
+   }
+   if(np == 0) continue;
+
+   /*
+    * Tabulate the sums of the pivot rows, indexed by their pivot bits
+    * (the submasks of pmask, in increasing order so each entry is an
+    * earlier one plus one row).
+    */
+   for(n = w;n < nw;n++) table[n] = 0;
+   s = 0;
+   do {
+     s = (s - pmask) & pmask;
+     b = __builtin_ctz(s);
+     for(n = 0;prow[n] != b;n++);
+     piv = mtx + (size_t)(i + n)*nw;
+     tent = table + (size_t)(s & (s - 1))*nw;
+     row = table + (size_t) s*nw;
+     for(n = w;n < nw;n++) row[n] = tent[n] ^ piv[n];
+   } while(s != pmask);
+
+   /*
+    * Clear the block in every row below.
+    */
+   i += np;
+   for(k = i;k < mrows;k++){
+     row = mtx + (size_t) k*nw;
+     s = (row[w] >> sh) & pmask;
+     if(s){
+       tent = table + (size_t) s*nw;
+       for(n = w;n < nw;n++) row[n] ^= tent[n];
+     }
+   }
+ }
+
+ free(table);
+ return(i);
+
+}
@@ -0,0 +1,124 @@
+/*
+ * See copyright in copyright.h and the accompanying file COPYING
+ */
+
+/*
+ *========================================================================
+ * The binary rank test on big square matrices.  The n x n matrix (n is
+ * -n, default 1024) is filled a row at a time with consecutive bits and
+ * its rank over {0,1} found with binary_rank64().  For an m x n matrix
+ * of random bits the probability of rank r is
+ *
+ *   2^(-(m-r)(n-r)) prod_{i=0}^{r-1} (1-2^(i-m))(1-2^(i-n))/(1-2^(i-r))
+ *
+ * which for m = n and a deficiency of d = n - r is very close to the
+ * same numbers for any n more than a few tens.  We count d = 0, 1, 2 and
+ * >= 3 and do a chisq test on the counts.
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+/*
+ * Default (and least) matrix size.
+ */
+#define RGB_RANK_N 1024
+#define RGB_RANK_NMIN 32
+
+/*
+ * The probability that an n x n matrix of random bits has rank n - d.
+ */
+static double rgb_rank_prob(int n,int d)
+{
+
+ int i,r;
+ double lp;
+
+ r = n - d;
+ lp = -(double) d*d*M_LN2;
+ for(i = 0;i < r;i++){
+   lp += 2.0*log1p(-ldexp(1.0,i - n)) - log1p(-ldexp(1.0,i - r));
+ }
+ return(exp(lp));
+
+}
+
+int rgb_binary_rank(Test **test,int irun)
+{
+
+ int i,j,n,nu,nw,d,rank;
+ uint t;
+ uint64_t *mtx,*row,lastmask;
+ double ptot;
+ Vtest vtest;
+ dh_context *ctx = test[0]->ctx;
+
+ if(ctx->ntuple < RGB_RANK_NMIN){
+   test[0]->ntuple = RGB_RANK_N;
+ } else {
+   test[0]->ntuple = ctx->ntuple;
+ }
+ n = test[0]->ntuple;
+ nu = (n + 31)/32;            /* uints per row */
+ nw = (n + 63)/64;            /* uint64_t's per row */
+ lastmask = (n%64) ? (((uint64_t) 1 << (n%64)) - 1) : ~(uint64_t) 0;
+
+ MYDEBUG(D_BRANK){
+   printf("# rgb_binary_rank(): %d x %d matrices, %u of them\n",n,n,test[0]->tsamples);
+ }
+
+ mtx = (uint64_t *) malloc((size_t) n*nw*sizeof(uint64_t));
+
+ /*
+  * x[d] counts the matrices of rank n - d, the last one all of rank
+  * n - 3 or less.
+  */
+ Vtest_create(&vtest,4);
+ vtest.cutoff = 5.0;
+ ptot = 0.0;
+ for(d = 0;d < 3;d++){
+   vtest.x[d] = 0.0;
+   vtest.y[d] = test[0]->tsamples*rgb_rank_prob(n,d);
+   ptot += rgb_rank_prob(n,d);
+ }
+ vtest.x[3] = 0.0;
+ vtest.y[3] = test[0]->tsamples*(1.0 - ptot);
+
+ dh_bits_reserve(ctx,(off_t) test[0]->tsamples*n*nu*32);
+ for(t = 0;t < test[0]->tsamples;t++){
+
+   /*
+    * Fill the rows, two uints to a word, low half first.
+    */
+   for(i = 0;i < n;i++){
+     row = mtx + (size_t) i*nw;
+     for(j = 0;j < nu;j++){
+       if(j%2 == 0){
+         row[j/2] = dh_bits_get32(ctx);
+       } else {
+         row[j/2] |= (uint64_t) dh_bits_get32(ctx) << 32;
+       }
+     }
+     row[nw-1] &= lastmask;
+   }
+
+   rank = binary_rank64(mtx,n,n);
+   MYDEBUG(D_BRANK){
+     printf("# rgb_binary_rank(): rank = %d\n",rank);
+   }
+   d = n - rank;
+   vtest.x[d < 3 ? d : 3]++;
+ }
+
+ Vtest_eval(&vtest);
+ test[0]->pvalues[irun] = vtest.pvalue;
+ MYDEBUG(D_BRANK) {
+   printf("# rgb_binary_rank(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
+ }
+
+ Vtest_destroy(&vtest);
+ free(mtx);
+
+ return(0);
+
+}
@@ -67,13 +67,16 @@ int rgb_bitdist(Test **test,int irun)
  uint value_max;   /* 2^{nb}, basically (max size of nb bit word + 1) */
  uint bsamples;    /* The number of non-overlapping samples in buffer */
  uint value;       /* value of sampled ntuple (as a uint) */
- uint mask;
+ uint tsamples;    /* local copy of test[0]->tsamples */
+ dh_context *ctx = test[0]->ctx;
 
  /* Look for cruft below */
 
  uint b,t,i;   /* loop indices? */
  uint ri;
  uint *count,ctotal; /* count of any ntuple per bitstring */
+ uint sample[64];    /* the bsamples ntuples of the current bitstring */
+ uint nvisit;        /* number of count entries to visit per bitstring */
 
  double ntuple_prob,pbin;  /* probabilities */
  Vtest *vtest;               /* A reusable vector of binomial test bins */
@@ -81,12 +84,12 @@ int rgb_bitdist(Test **test,int irun)
  /*
   * Sample a bitstring ntuple in length (exactly).
   */
- if(ntuple>0){
+ if(ctx->ntuple>0){
    /*
     * Set test[0]->ntuple to pass back to output()
     */
-   test[0]->ntuple = ntuple;
-   nb = ntuple;
+   test[0]->ntuple = ctx->ntuple;
+   nb = ctx->ntuple;
    MYDEBUG(D_RGB_BITDIST){
      printf("# rgb_bitdist: Testing ntuple = %u\n",nb);
    }
@@ -144,22 +147,6 @@ int rgb_bitdist(Test **test,int irun)
    
  tsamples = test[0]->tsamples;
 
- /*
-  * Set the mask for bits to be returned.  I think that I want to
-  * change routines here over to the sliding window routine.
-  *
-  * The following mask will work OK, but John says that it won't
-  * work unless nb != CHAR_BIT*sizeof(uint), so the loop is a bit
-  * more robust.
-  *
-  *  mask = ((1u << nb) - 1);
-  */
- mask = 0;
- for(i = 0; i < nb; i++){
-   mask |= (1u << nb);
- }
- mask = ((1u << nb) - 1);
-
  /*
   * OK, I'm getting to where I think I can manage to fix this test once
   * and for all.  I want to make this test evaluate a counter:
@@ -224,6 +211,8 @@ int rgb_bitdist(Test **test,int irun)
   * bitcount.
   */
  memset(count,0,value_max*sizeof(uint));
+ nvisit = (value_max < bsamples) ? value_max : bsamples;
+ dh_bits_reserve(ctx,(off_t) tsamples*bsamples*nb);
  for(t=0;t<tsamples;t++){
 
    /*
@@ -238,8 +227,25 @@ int rgb_bitdist(Test **test,int irun)
       * skipping bits.  Then increment the count of this ntuple value's
       * occurrence out of bsamples tries.
       */
-     value = get_rand_bits_uint (nb, mask, rng);
+     switch(nb){
+       case 1:
+         value = dh_bits_get1(ctx);
+         break;
+       case 2:
+         value = dh_bits_get2(ctx);
+         break;
+       case 4:
+         value = dh_bits_get4(ctx);
+         break;
+       case 8:
+         value = dh_bits_get8(ctx);
+         break;
+       default:
+         value = dh_bits_get(ctx,nb);
+         break;
+     }
      count[value]++;
+     sample[b] = value;
 
      MYDEBUG(D_RGB_BITDIST) {
        printf("# rgb_bitdist():b=%u count[%u] = %u\n",b,value,count[value]);
@@ -249,21 +255,27 @@ int rgb_bitdist(Test **test,int irun)
 
    /*
     * We now increment the CUMULATIVE counter -- vtest -- so we can
-    * compare the result to the expected value when we're done.
+    * compare the result to the expected value when we're done.  Only
+    * the (at most bsamples) values that turned up have a nonzero count,
+    * so for large ntuples we visit those rather than all value_max of
+    * them, clearing each count as we go so that the next sample starts
+    * from zero.
     */
    ctotal = 0;
-   for(i=0;i<value_max;i++){
-      uint count_i = count[i];
+   for(b=0;b<nvisit;b++){
+      uint count_i;
+      i = (nvisit == value_max) ? b : sample[b];
+      count_i = count[i];
       if (count_i)
 	{
-	   count[i] = 0;		       /* performs memset */
+	   count[i] = 0;
 	   ctotal += count_i;
 	   vtest[i].x[count_i]++;
 	   vtest[i].x[0]--;
+	   MYDEBUG(D_RGB_BITDIST){
+	     printf("# rgb_bitdist(): vtest[%u].x[%u] = %u\n",i,count_i,(uint)vtest[i].x[count_i]);
+	   }
 	}
-      MYDEBUG(D_RGB_BITDIST){
-	 printf("# rgb_bitdist(): vtest[%u].x[%u] = %u\n",i,count[i],(uint)vtest[i].x[count[i]]);
-     }
    }
    MYDEBUG(D_RGB_BITDIST){
      printf("# rgb_bitdist(): Sample %u: total count = %u (should be %u, count of bits)\n",t,ctotal,bits);
@@ -283,7 +295,7 @@ int rgb_bitdist(Test **test,int irun)
    printf("# rgb_bitdist():            vtest table\n");
    printf("# rgb_bitdist(): Outcome   bit          x           y       sigma\n");
  }
- ri = gsl_rng_uniform_int(rng,value_max);
+ ri = gsl_rng_uniform_int(ctx->rng,value_max);
  for(i=0;i<value_max;i++){
    for(b=0;b<=bsamples;b++){
      MYDEBUG(D_RGB_BITDIST){
@@ -294,14 +306,14 @@ int rgb_bitdist(Test **test,int irun)
    MYDEBUG(D_RGB_BITDIST){
      printf("# rgb_bitdist():=====================================================\n");
    }
-   Vtest_eval(&vtest[i]);
 
    /*
     * NOTE NOTE NOTE
     *
     * This is a bit nasty.  We can only save ONE pvalue per call.  The
     * only way to do so without bias is to randomly select which one to
-    * save from large set of possibilities.
+    * save from large set of possibilities (and so only that one need be
+    * scored).
     *
     * However, this sucks.  Eventually I need to figure out how to
     * turn the whole list of pvalues into a pvalue.  They are NOT
@@ -313,6 +325,7 @@ int rgb_bitdist(Test **test,int irun)
     * pattern distribution will usually be systematic.
     */
    if(i == ri ) {
+     Vtest_eval(&vtest[i]);
      test[0]->pvalues[irun] = vtest[i].pvalue;
      MYDEBUG(D_RGB_BITDIST) {
        printf("# rgb_bitdist(): test[%u]->pvalues[%u] = %10.5f\n",
@@ -0,0 +1,132 @@
+/*
+ * See copyright in copyright.h and the accompanying file COPYING
+ */
+
+/*
+ *========================================================================
+ * rgb_bitdist for every ntuple from 1 to RGB_BITDIST_NTMAX in one pass.
+ * rgb_bitdist keeps one p-value per call, that of the histogram of a
+ * value ri picked at random once the counts are in.  Here the twelve
+ * ri are picked first, and as the value does not depend on the data
+ * this is the same test, but now we only have to count how often ri
+ * turns up in each sample of 64 ntuples, not tally every value.
+ *
+ * Every sample reads one buffer of 64*(1+2+...+12) bits, as 64 bit
+ * words, and width nb takes its nb words of it, so no bit is used by
+ * two widths.  For widths that divide 64 the ntuples never straddle a
+ * word, and a whole word is compared with ri at once:  xor it with ri
+ * repeated across the word, or together the bits of each field and
+ * popcount the fields that are left zero.  The other widths are read an
+ * ntuple at a time, without branches.
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+#define BITDIST_BSAMPLES 64
+#define BITDIST_NWORDS (RGB_BITDIST_NTMAX*(RGB_BITDIST_NTMAX+1)/2)
+
+static inline uint bitdist_popcount(uint64_t x)
+{
+
+#if defined(__GNUC__)
+ return(__builtin_popcountll(x));
+#else
+ x = x - ((x >> 1) & 0x5555555555555555ULL);
+ x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+ x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+ return((uint)((x*0x0101010101010101ULL) >> 56));
+#endif
+
+}
+
+/*
+ * The number of the 64 nb bit ntuples in w[0..nb-1] (most significant
+ * bit first) that are equal to r.  w[nb] must be readable.
+ */
+static uint bitdist_count(const uint64_t *w,uint nb,uint r)
+{
+
+ uint64_t ones,rep,x;
+ uint i,s,o,c = 0;
+
+ if((64 % nb) == 0){
+   ones = ~(uint64_t) 0/(((uint64_t) 1 << nb) - 1);  /* the low bit of each field */
+   rep = ones*r;
+   for(i = 0;i < nb;i++){
+     x = w[i] ^ rep;
+     for(s = 1;s < nb;s <<= 1) x |= x >> s;
+     c += 64/nb - bitdist_popcount(x & ones);
+   }
+ } else {
+   for(i = 0,o = 0;i < BITDIST_BSAMPLES;i++,o += nb){
+     s = o & 63;
+     x = (w[o >> 6] << s | (w[(o >> 6) + 1] >> 1) >> (63 - s)) >> (64 - nb);
+     c += (x == r);
+   }
+ }
+ return(c);
+
+}
+
+int rgb_bitdist_all(Test **test,int irun)
+{
+
+ uint nb,b,i,t,off,tsamples;
+ uint ri[RGB_BITDIST_NTMAX];
+ uint hist[RGB_BITDIST_NTMAX][BITDIST_BSAMPLES+1];
+ uint buf[2*BITDIST_NWORDS];
+ uint64_t w[BITDIST_NWORDS+1];
+ Vtest vtest;
+ dh_context *ctx = test[0]->ctx;
+
+ tsamples = test[0]->tsamples;
+ for(nb = 1;nb <= RGB_BITDIST_NTMAX;nb++){
+   test[nb-1]->ntuple = nb;
+   ri[nb-1] = gsl_rng_uniform_int(ctx->rng,1 << nb);
+   MYDEBUG(D_RGB_BITDIST){
+     printf("# rgb_bitdist_all(): ntuple %u, counting value %u\n",nb,ri[nb-1]);
+   }
+ }
+ memset(hist,0,sizeof(hist));
+
+ w[BITDIST_NWORDS] = 0;
+ for(t = 0;t < tsamples;t++){
+   dh_uint_fill(ctx,buf,2*BITDIST_NWORDS);
+   for(i = 0;i < BITDIST_NWORDS;i++){
+     w[i] = (uint64_t) buf[2*i] << 32 | buf[2*i+1];
+   }
+   off = 0;
+   for(nb = 1;nb <= RGB_BITDIST_NTMAX;nb++){
+     hist[nb-1][bitdist_count(w + off,nb,ri[nb-1])]++;
+     off += nb;
+   }
+ }
+
+ /*
+  * Score each width exactly as rgb_bitdist scores its chosen value.
+  */
+ Vtest_create(&vtest,BITDIST_BSAMPLES+1);
+ vtest.cutoff = 20.0;
+ for(nb = 1;nb <= RGB_BITDIST_NTMAX;nb++){
+   for(b = 0;b <= BITDIST_BSAMPLES;b++){
+     vtest.x[b] = hist[nb-1][b];
+     vtest.y[b] = tsamples*gsl_ran_binomial_pdf(b,1.0/(double)(1 << nb),BITDIST_BSAMPLES);
+     MYDEBUG(D_RGB_BITDIST){
+       printf("# rgb_bitdist_all():  %3u     %3u   %10.5f  %10.5f\n",
+         nb,b,vtest.x[b],vtest.y[b]);
+     }
+   }
+   vtest.ndof = 0;       /* Vtest_eval() fills it in from the cutoff */
+   Vtest_eval(&vtest);
+   test[nb-1]->pvalues[irun] = vtest.pvalue;
+   MYDEBUG(D_RGB_BITDIST){
+     printf("# rgb_bitdist_all(): test[%u]->pvalues[%u] = %10.5f\n",
+       nb-1,irun,test[nb-1]->pvalues[irun]);
+   }
+ }
+ Vtest_destroy(&vtest);
+
+ return(0);
+
+}
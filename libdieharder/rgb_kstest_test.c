@@ -40,6 +40,7 @@ int rgb_kstest_test(Test **test, int irun)
 
  uint t,tsamples;
  double *testvec;
+ dh_context *ctx = test[0]->ctx;
 
  tsamples = test[0]->tsamples;
  testvec = (double *)malloc(tsamples*sizeof(double));
@@ -52,13 +53,13 @@ int rgb_kstest_test(Test **test, int irun)
    /*
     * Generate and (conditionally) print out a point.
     */
-   testvec[t] = gsl_rng_uniform_pos(rng);
+   testvec[t] = gsl_rng_uniform_pos(ctx->rng);
    if(verbose == D_RGB_KSTEST_TEST || verbose == D_ALL){
        printf("testvec[%u] = %f",t,testvec[t]);
    }
  }
 
- if(ks_test >= 3){
+ if(ctx->ks_test >= 3){
    /*
     * This (Kuiper) can be selected with -k 3 from the command line.
     * All other values test variants of the regular kstest().
@@ -42,12 +42,13 @@ int rgb_lagged_sums(Test **test,int irun)
 
  uint t,i,lag;
  Xtest ptest;
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * Get the lag from ntuple.  Note that a lag of zero means
   * "don't throw any away".
   */
- test[0]->ntuple = ntuple;
+ test[0]->ntuple = ctx->ntuple;
  lag = test[0]->ntuple;
 
  /*
@@ -71,10 +72,10 @@ int rgb_lagged_sums(Test **test,int irun)
     */
 
    /* Throw away lag per sample */
-   for(i=0;i<lag;i++) gsl_rng_uniform(rng);
+   for(i=0;i<lag;i++) gsl_rng_uniform(ctx->rng);
 
    /* sample only every lag numbers, reset counter */
-   ptest.x += gsl_rng_uniform(rng);
+   ptest.x += gsl_rng_uniform(ctx->rng);
 
  }
 
@@ -40,7 +40,6 @@
 
 #include <dieharder/libdieharder.h>
 
-double rgb_mindist_avg;
 static double rgb_md_Q[] = {0.0,0.0,0.4135,0.5312,0.6202,1.3789};
 
 int compare_points(const dTuple *a,const dTuple *b)
@@ -66,18 +65,17 @@ double distance(const dTuple a,const dTuple b,uint dim)
 int rgb_minimum_distance(Test **test, int irun)
 {
 
- int i,j,d,t;
+ int d,t;
  uint rgb_md_dim;
  
  /*
-  * These are the vector of points and the current point being
-  * considered.  We may or may not need to restructure the vectors
-  * to be able to do the sort.  I'm going to TRY to implement
-  * Fischler's suggested algorithm here that is NlogN instead of doing
-  * the straightforward N^2 algorithm, but we'll see.
+  * These are the vectors of the coordinates of the points, one per
+  * dimension (see dh_mindist2()).
   */
- dTuple *points;
- double earg,qarg,dist,mindist,dvolume;
+ double *points[RGB_MINIMUM_DISTANCE_MAXDIM];
+ double earg,qarg,mindist,dvolume;
+ double rgb_mindist_avg;
+ dh_context *ctx = test[0]->ctx;
 
  rgb_mindist_avg = 0.0;
 
@@ -85,15 +83,14 @@ int rgb_minimum_distance(Test **test, int irun)
   * Generate d-tuples of tsamples random coordinates in the range
   * 0-10000 (which we may have to scale with dimension). Determine
   * the shortest separation of two points by any means available:
-  * a double loop is simplest and slowest, or we can sort the list
-  * of coordinates on the value of the first coordinate and evaluate
-  * distances for each point only until the distance to the next
-  * coordinate exceeds the minimum found so far, which scales like
-  * the sort (n log n) instead of the double loop (n^2).  From this
-  * we generate p from the Fischler form including corrections,
-  * actually computed in place so that e.g. n can be a variable, and
-  * apply the usual KS test over psamples of independent tests, per
-  * dimension.
+  * a double loop is simplest and slowest, sorting the list of points
+  * on the first coordinate and sweeping it is n log n but gets slow
+  * for large n in higher dimensions, and dh_mindist2() bins the points
+  * into a grid of cells and only compares neighbors, which scales like
+  * n.  From this we generate p from the Fischler form including
+  * corrections, actually computed in place so that e.g. n can be a
+  * variable, and apply the usual KS test over psamples of independent
+  * tests, per dimension.
   *
   * Actually, I don't see any particular reason that the d-cube should
   * be of "length 10000".  In fact, it seems pretty obvious that it
@@ -101,13 +98,17 @@ int rgb_minimum_distance(Test **test, int irun)
   * floating point variables.  Is there some aspect of this test that cares
   * what the "scale" is?  I don't think so.
   */
- points = (dTuple *)malloc(test[0]->tsamples*sizeof(dTuple));
  /*
   * Set this for output.  ntuple should be set from the CLI or from
-  * -a(ll) (run_all_tests()).
+  * -a(ll) (run_all_tests()), by way of the context.
   */
- test[0]->ntuple = ntuple;
+ if(ctx->ntuple < 2 || ctx->ntuple > RGB_MINIMUM_DISTANCE_MAXDIM){
+   test[0]->ntuple = RGB_MINIMUM_DISTANCE_MAXDIM;
+ } else {
+   test[0]->ntuple = ctx->ntuple;
+ }
  rgb_md_dim = test[0]->ntuple;
+ for(d=0;d<rgb_md_dim;d++) points[d] = (double *)malloc(test[0]->tsamples*sizeof(double));
 
  if(verbose == D_RGB_MINIMUM_DISTANCE || verbose == D_ALL){
      printf("Generating a list of %u points in %d dimensions\n",test[0]->tsamples,rgb_md_dim);
@@ -122,33 +123,9 @@ int rgb_minimum_distance(Test **test, int irun)
        printf("points[%u]: (",t);
    }
    for(d=0;d<rgb_md_dim;d++) {
-     points[t].c[d] = gsl_rng_uniform_pos(rng);
+     points[d][t] = gsl_rng_uniform_pos(ctx->rng);
      if(verbose == D_RGB_MINIMUM_DISTANCE || verbose == D_ALL){
-       printf("%6.4f",points[t].c[d]);
-       if(d == rgb_md_dim - 1){
-         printf(")\n");
-       } else {
-         printf(",");
-       }
-     }
-   }
- }
-
- /*
-  * Now we sort the points using gsl_heapsort and a comparator
-  * on the first coordinate only.  Don't know how to get rid
-  * of the gcc prototype warning.  Probably need a cast of some
-  * sort.
-  */
- gsl_heapsort(points,test[0]->tsamples,sizeof(dTuple),
-                    (gsl_comparison_fn_t) compare_points);
-
- if(verbose == D_RGB_MINIMUM_DISTANCE || verbose == D_ALL){
-   printf("List of points sorted by first coordinate:\n");
-   for(t=0;t<test[0]->tsamples;t++){
-     printf("points[%u]: (",t);
-     for(d=0;d<rgb_md_dim;d++) {
-       printf("%6.4f",points[t].c[d]);
+       printf("%6.4f",points[d][t]);
        if(d == rgb_md_dim - 1){
          printf(")\n");
        } else {
@@ -159,27 +136,13 @@ int rgb_minimum_distance(Test **test, int irun)
  }
 
  /*
-  * Now we do the SINGLE PASS through to determine mindist
+  * Now find mindist.  One thing to experiment with here (very much) is
+  * whether or not we need periodic wraparound.  For the moment we omit
+  * it, although distributing the points on a euclidean d-torus seems
+  * more symmetric than not and checks to be sure that points are
+  * correct on or very near a boundary.
   */
- mindist = 1.0;
- for(i=0;i<test[0]->tsamples;i++){
-   /*
-    * One thing to experiment with here (very much) is
-    * whether or not we need periodic wraparound.  For
-    * the moment we omit it, although distributing
-    * the points on a euclidean d-torus seems more symmetric
-    * than not and checks to be sure that points are correct
-    * on or very near a boundary.
-    */
-   for(j=i+1;j<test[0]->tsamples;j++){
-     if(points[j].c[0] - points[i].c[0] > mindist) break;
-     dist = distance(points[j],points[i],rgb_md_dim);
-     MYDEBUG(D_RGB_MINIMUM_DISTANCE) {
-       printf("d(%d,%d) = %16.10e\n",i,j,dist);
-     }
-     if( dist < mindist) mindist = dist;
-   }
- }
+ mindist = sqrt(dh_mindist2(points,test[0]->tsamples,rgb_md_dim,1.0));
  MYDEBUG(D_RGB_MINIMUM_DISTANCE) {
    printf("Found rmin = %16.10e\n",mindist);
  }
@@ -206,7 +169,7 @@ int rgb_minimum_distance(Test **test, int irun)
  /* qarg = 1.0; */
  test[0]->pvalues[irun] = 1.0 - exp(earg)*qarg;
 
- free(points);
+ for(d=0;d<rgb_md_dim;d++) free(points[d]);
 
  MYDEBUG(D_RGB_MINIMUM_DISTANCE) {
    printf("# diehard_2dsphere(): test[0]->pvalues[%u] = %10.5f\n",irun,test[0]->pvalues[irun]);
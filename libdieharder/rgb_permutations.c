@@ -12,7 +12,6 @@
 #include <dieharder/libdieharder.h>
 
 #define RGB_PERM_KMAX 10
-uint nperms;
 double fpipi(int pi1,int pi2,int nkp);
 uint rgb_permutations_k;
 
@@ -20,10 +19,12 @@ int rgb_permutations(Test **test,int irun)
 {
 
  uint i,k,permindex=0,t;
+ uint nperms;
  Vtest vtest;
  double *testv;
  size_t ps[4096];
  gsl_permutation** lookup;
+ dh_context *ctx = test[0]->ctx;
 
 
  MYDEBUG(D_RGB_PERMUTATIONS){
@@ -36,10 +37,10 @@ int rgb_permutations(Test **test,int irun)
   * valid test is 2.  If ntuple is less than 2, we choose the default
   * test size as 5 (like operm5).
   */
- if(ntuple<2){
+ if(ctx->ntuple<2){
    test[0]->ntuple = 5;
  } else {
-   test[0]->ntuple = ntuple;
+   test[0]->ntuple = ctx->ntuple;
  }
  k = test[0]->ntuple;
  nperms = gsl_sf_fact(k);
@@ -103,7 +104,7 @@ int rgb_permutations(Test **test,int irun)
     * To sort into a perm, test vector needs to be double.
     */
    for(i=0;i<k;i++) {
-     testv[i] = (double) gsl_rng_get(rng);
+     testv[i] = (double) gsl_rng_get(ctx->rng);
      MYDEBUG(D_RGB_PERMUTATIONS){
        printf("# rgb_permutations: testv[%u] = %u\n",i,(uint) testv[i]);
      }
@@ -50,7 +50,7 @@ int rgb_persist(Test **test, Rgb_Persist *persist)
    /*
     * Fill rgb_persist_rand_uint with a string of random numbers
     */
-   for(i=0;i<256;i++) rgb_persist_rand_uint[i] = gsl_rng_get(rng);
+   dh_rng_fill(rng,rgb_persist_rand_uint,256);
    last_rand = rgb_persist_rand_uint[0];  /* to start it */
    persist->and_mask = ~(last_rand ^ rgb_persist_rand_uint[0]);
    for(i=0;i<256;i++){
@@ -19,7 +19,7 @@ int rgb_timing(Test **test, Rgb_Timing *timing)
 {
 
  double total_time,avg_time;
- int i,j;
+ int i;
  unsigned int *rand_uint;
 
  MYDEBUG(D_RGB_TIMING){
@@ -34,9 +34,7 @@ int rgb_timing(Test **test, Rgb_Timing *timing)
  total_time = 0.0;
  for(i=0;i<test[0]->psamples;i++){
    start_timing();
-   for(j=0;j<test[0]->tsamples;j++){
-     rand_uint[j] = gsl_rng_get(rng);
-   }
+   dh_rng_fill(rng,rand_uint,test[0]->tsamples);
    stop_timing();
    total_time += delta_timing();
  }
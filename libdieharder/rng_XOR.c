@@ -8,6 +8,7 @@
  */
 
 #include <dieharder/libdieharder.h>
+#include <pthread.h>
 
 /*
  * This is a special XOR generator that takes a list of GSL
@@ -16,35 +17,243 @@
  * MUST be the XOR rng itself.  So there have to be at least two -g X
  * stanzas on the command line to use XOR, and if there aren't three
  * or more it doesn't "do" anything but use the second one.
+ *
+ * (It has always used TWO successive returns of the second generator
+ * for every return, and still does, so that a given set of generators
+ * and seed produces the same stream as it always did.)
+ *
+ * Rather than calling every generator once per return, we make XOR_BUF
+ * returns at a time:  each generator fills a block through dh_rng_fill()
+ * and the blocks are XOR'd together a vector at a time.  Generators that
+ * read a file or stdin can be slow enough to hold up all of the others,
+ * so when we are allowed more than one thread (-j) each of those gets a
+ * thread of its own that fills its next block while we use the last.
  */
 static unsigned long int XOR_get (void *vstate);
 static double XOR_get_double (void *vstate);
 static void XOR_set (void *vstate, unsigned long int s);
 
+#define XOR_BUF 4096
+
+/*
+ * The prefetch thread of a slow generator and its two blocks.  It lives
+ * on the heap, apart from the state, and only ever touches itself.
+ */
+typedef struct {
+  gsl_rng *rng;
+  size_t n;                     /* uints per block */
+  unsigned int *buf[2];
+  int full[2];
+  int next;                     /* Block to be used next */
+  int quit;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_t thread;
+} XOR_prefetch_t;
+
 typedef struct {
   /*
    * internal gsl random number generator vector
    */
   gsl_rng *grngs[GVECMAX];
+  XOR_prefetch_t *pf[GVECMAX];  /* Prefetch threads of slow generators */
+  int threaded;                 /* Use prefetch threads */
   unsigned int XOR_rnd;
+  unsigned int out[XOR_BUF];    /* The returns of the last refill... */
+  unsigned int pos;             /* ...and the next one to hand out */
+  unsigned int tmp[2*XOR_BUF];  /* A block of one generator */
 } XOR_state_t;
 
+#if defined(__GNUC__)
+typedef unsigned int XOR_vec __attribute__ ((vector_size (32),aligned (4),__may_alias__));
+#endif
+
+/*
+ * dst[0..n-1] ^= src[0..n-1]
+ */
+static inline void XOR_into(unsigned int *dst,const unsigned int *src,size_t n)
+{
+
+ size_t i = 0;
+
+#if defined(__GNUC__)
+ size_t nv = n - n%8;
+
+ for(;i < nv;i += 8){
+   *(XOR_vec *)(dst + i) ^= *(const XOR_vec *)(src + i);
+ }
+#endif
+ for(;i < n;i++){
+   dst[i] ^= src[i];
+ }
+
+}
+
+static void *XOR_prefetch_thread(void *arg)
+{
+
+ XOR_prefetch_t *pf = (XOR_prefetch_t *) arg;
+ int b = 0;
+
+ pthread_mutex_lock(&pf->lock);
+ while(1){
+   while(pf->full[b] && !pf->quit) pthread_cond_wait(&pf->cond,&pf->lock);
+   if(pf->quit) break;
+   pthread_mutex_unlock(&pf->lock);
+   dh_rng_fill(pf->rng,pf->buf[b],pf->n);
+   pthread_mutex_lock(&pf->lock);
+   pf->full[b] = 1;
+   pthread_cond_broadcast(&pf->cond);
+   b ^= 1;
+ }
+ pthread_mutex_unlock(&pf->lock);
+ return(0);
+
+}
+
+static XOR_prefetch_t *XOR_prefetch_start(gsl_rng *rng,size_t n)
+{
+
+ XOR_prefetch_t *pf;
+
+ pf = (XOR_prefetch_t *)malloc(sizeof(XOR_prefetch_t));
+ memset(pf,0,sizeof(XOR_prefetch_t));
+ pf->rng = rng;
+ pf->n = n;
+ pf->buf[0] = (unsigned int *)malloc(2*n*sizeof(unsigned int));
+ pf->buf[1] = pf->buf[0] + n;
+ pthread_mutex_init(&pf->lock,NULL);
+ pthread_cond_init(&pf->cond,NULL);
+ if(pthread_create(&pf->thread,NULL,XOR_prefetch_thread,pf) != 0){
+   free(pf->buf[0]);
+   free(pf);
+   return(0);
+ }
+ return(pf);
+
+}
+
+static void XOR_prefetch_stop(XOR_prefetch_t *pf)
+{
+
+ pthread_mutex_lock(&pf->lock);
+ pf->quit = 1;
+ pthread_cond_broadcast(&pf->cond);
+ pthread_mutex_unlock(&pf->lock);
+ pthread_join(pf->thread,NULL);
+ pthread_mutex_destroy(&pf->lock);
+ pthread_cond_destroy(&pf->cond);
+ free(pf->buf[0]);
+ free(pf);
+
+}
+
+/*
+ * The next block of pf, and giving it back when we are done with it.
+ */
+static unsigned int *XOR_prefetch_take(XOR_prefetch_t *pf)
+{
+
+ pthread_mutex_lock(&pf->lock);
+ while(!pf->full[pf->next]) pthread_cond_wait(&pf->cond,&pf->lock);
+ pthread_mutex_unlock(&pf->lock);
+ return(pf->buf[pf->next]);
+
+}
+
+static void XOR_prefetch_give(XOR_prefetch_t *pf)
+{
+
+ pthread_mutex_lock(&pf->lock);
+ pf->full[pf->next] = 0;
+ pthread_cond_broadcast(&pf->cond);
+ pthread_mutex_unlock(&pf->lock);
+ pf->next ^= 1;
+
+}
+
+/*
+ * The next block of n uints of generator i:  from its prefetch thread
+ * (started on first use) if it is slow and we may, else from tmp.
+ */
+static unsigned int *XOR_block(XOR_state_t *state,int i,size_t n)
+{
+
+ const char *name = gsl_rng_name(state->grngs[i]);
+
+ if(state->pf[i] == 0 && state->threaded &&
+    (strncmp(name,"file_input",10) == 0 || strncmp(name,"stdin_input",11) == 0)){
+   state->pf[i] = XOR_prefetch_start(state->grngs[i],n);
+ }
+ if(state->pf[i]) return(XOR_prefetch_take(state->pf[i]));
+ dh_rng_fill(state->grngs[i],state->tmp,n);
+ return(state->tmp);
+
+}
+
+/*
+ * The next XOR_BUF returns, into dst.
+ */
+static void XOR_refill(XOR_state_t *state,unsigned int *dst)
+{
+
+ unsigned int *src;
+ int i,j;
+
+ /*
+  * There is always this one, or we are in deep trouble.
+  */
+ src = XOR_block(state,1,2*XOR_BUF);
+ for(j=0;j<XOR_BUF;j++){
+   dst[j] = src[2*j] ^ src[2*j+1];
+ }
+ if(state->pf[1]) XOR_prefetch_give(state->pf[1]);
+ for(i=2;i<gvcount;i++){
+   src = XOR_block(state,i,XOR_BUF);
+   XOR_into(dst,src,XOR_BUF);
+   if(state->pf[i]) XOR_prefetch_give(state->pf[i]);
+ }
+
+}
+
 static inline unsigned long int
 XOR_get (void *vstate)
 {
  XOR_state_t *state = (XOR_state_t *) vstate;
- int i;
 
- /*
-  * There is always this one, or we are in deep trouble.  I am going
-  * to have to decorate this code with error checks...
-  */
- state->XOR_rnd = gsl_rng_get(state->grngs[1]);
- for(i=1;i<gvcount;i++){
-   state->XOR_rnd ^= gsl_rng_get(state->grngs[i]);
+ if(state->pos == XOR_BUF){
+   XOR_refill(state,state->out);
+   state->pos = 0;
  }
+ state->XOR_rnd = state->out[state->pos++];
  return state->XOR_rnd;
- 
+
+}
+
+/*
+ * XOR_get() n times.  Whole refills go straight into buf.
+ */
+void XOR_fill (void *vstate, unsigned int *buf, size_t n)
+{
+ XOR_state_t *state = (XOR_state_t *) vstate;
+ size_t k;
+
+ k = XOR_BUF - state->pos;
+ if(k > n) k = n;
+ memcpy(buf,&state->out[state->pos],k*sizeof(unsigned int));
+ state->pos += k;
+ buf += k;
+ n -= k;
+ for(;n >= XOR_BUF;n -= XOR_BUF){
+   XOR_refill(state,buf);
+   buf += XOR_BUF;
+ }
+ if(n){
+   XOR_refill(state,state->out);
+   memcpy(buf,state->out,n*sizeof(unsigned int));
+   state->pos = n;
+ }
+
 }
 
 static double
@@ -53,12 +262,39 @@ XOR_get_double (void *vstate)
   return XOR_get (vstate) / (double) UINT_MAX;
 }
 
+/*
+ * Stop the prefetch threads and free the component generators (and
+ * whatever they had made).  dh_rng_free() calls this for an XOR
+ * instance, and XOR_set() before a reseed.
+ */
+void XOR_free (void *vstate)
+{
+ XOR_state_t *state = (XOR_state_t *) vstate;
+ int i;
+
+ for(i=0;i<gvcount;i++){
+   if(state->pf[i]){
+     XOR_prefetch_stop(state->pf[i]);
+     state->pf[i] = 0;
+   }
+   if(state->grngs[i]){
+     dh_rng_free(state->grngs[i]);
+     state->grngs[i] = 0;
+   }
+ }
+
+}
+
 static void XOR_set (void *vstate, unsigned long int s) {
 
  XOR_state_t *state = (XOR_state_t *) vstate;
  int i;
  uint seed_seed;
 
+ XOR_free(state);
+ state->pos = XOR_BUF;
+ state->threaded = jobs > 1;
+
  /*
   * OK, here's how it works.  grngs[0] is set to mt19937_1999, seeded
   * as per usual, and used (ONLY) to see the remaining generators.
@@ -20,18 +20,45 @@
 #include <dieharder/libdieharder.h>
 #include <dieharder/rijndael-alg-fst.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AES_X86 1
+#include <wmmintrin.h>
+#endif
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES))
+#define AES_ARM 1
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
 // State blocks = 1 for weakest form
 #define STATE_BLOCKS (1)	/* MUST be 1 for AES */
 #define BLOCKS_SIZE (16 * STATE_BLOCKS)
 #define NR 10
 
+// OFB blocks made per refill of the output buffer
+#define OUT_BLOCKS (64)
+#define OUT_SIZE (BLOCKS_SIZE * OUT_BLOCKS)
+
 /*
  * This is a wrapping of the AES algorithm as a generator
+ *
+ * The generator is AES-128 in OFB mode: the state is one block, which
+ * is encrypted in place to make each next block of output.  That chain
+ * can't be split up, but we can run it OUT_BLOCKS blocks at a time
+ * into an output buffer, with AES-NI (x86) or the ARMv8 crypto
+ * extension when the CPU has them (see aes_choose()) and with the
+ * portable rijndaelEncrypt() otherwise.  All three make the same
+ * stream, out[0] being the first block and out[OUT_BLOCKS-1] the
+ * state for the next refill.
  */
 
 typedef struct {
 	u32 rk[4*(NR + 1)];
-	unsigned char block[BLOCKS_SIZE];
+	u8 kb[16*(NR + 1)];	/* rk as bytes, for the hardware kernels */
+	unsigned char out[OUT_SIZE];
 	short int pos;
 } AES_state_t;
 
@@ -39,16 +66,122 @@ unsigned long int aes_get (void *vstate);
 double aes_get_double (void *vstate);
 void aes_set (void *vstate, unsigned long int s);
 
+/*
+ * Encrypt block n times over, putting each result in out[16*i].  block
+ * may be the last block of out.  The portable kernel uses the round
+ * keys rk, the hardware ones the same keys as bytes, kb.
+ */
+typedef void (*aes_ofb_t)(const u32 *rk, const u8 *kb, const u8 *block, u8 *out, size_t n);
+
+static void aes_ofb_portable (const u32 *rk, const u8 *kb, const u8 *block, u8 *out, size_t n) {
+	u8 b[16];
+	size_t i;
+
+	memcpy(b, block, 16);
+	for (i = 0; i < n; i++) {
+		rijndaelEncrypt(rk, NR, b, b);
+		memcpy(out + 16 * i, b, 16);
+	}
+}
+
+/*
+ * The hardware kernels want the round keys as bytes in the order of the
+ * key itself, rk holds them as big endian words.  aes_set() makes them
+ * once per key.
+ */
+static void aes_key_bytes (const u32 *rk, u8 *kb) {
+	int i;
+
+	for (i = 0; i < 4*(NR + 1); i++) {
+		kb[4*i] = (u8) (rk[i] >> 24);
+		kb[4*i + 1] = (u8) (rk[i] >> 16);
+		kb[4*i + 2] = (u8) (rk[i] >> 8);
+		kb[4*i + 3] = (u8) rk[i];
+	}
+}
+
+#ifdef AES_X86
+__attribute__((target("aes,sse2")))
+static void aes_ofb_aesni (const u32 *rk, const u8 *kb, const u8 *block, u8 *out, size_t n) {
+	__m128i k[NR + 1], b;
+	size_t i;
+	int r;
+
+	for (r = 0; r <= NR; r++) k[r] = _mm_loadu_si128((const __m128i *) (kb + 16 * r));
+	b = _mm_loadu_si128((const __m128i *) block);
+	for (i = 0; i < n; i++) {
+		b = _mm_xor_si128(b, k[0]);
+		for (r = 1; r < NR; r++) b = _mm_aesenc_si128(b, k[r]);
+		b = _mm_aesenclast_si128(b, k[NR]);
+		_mm_storeu_si128((__m128i *) (out + 16 * i), b);
+	}
+}
+#endif
+
+#ifdef AES_ARM
+static void aes_ofb_armv8 (const u32 *rk, const u8 *kb, const u8 *block, u8 *out, size_t n) {
+	uint8x16_t k[NR + 1], b;
+	size_t i;
+	int r;
+
+	for (r = 0; r <= NR; r++) k[r] = vld1q_u8(kb + 16 * r);
+	b = vld1q_u8(block);
+	for (i = 0; i < n; i++) {
+		for (r = 0; r < NR - 1; r++) b = vaesmcq_u8(vaeseq_u8(b, k[r]));
+		b = veorq_u8(vaeseq_u8(b, k[NR - 1]), k[NR]);
+		vst1q_u8(out + 16 * i, b);
+	}
+}
+#endif
+
+/*
+ * Pick the fastest kernel this CPU can run, once.  Instances in several
+ * threads (-j, parallel psamples) may get here together; they all pick
+ * the same kernel, and it is read and written atomically.
+ */
+static aes_ofb_t aes_ofb = 0;
+
+static aes_ofb_t aes_choose (void) {
+	aes_ofb_t f = aes_ofb_portable;
+
+#ifdef AES_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("aes")) f = aes_ofb_aesni;
+#endif
+#ifdef AES_ARM
+#if defined(__linux__) && defined(HWCAP_AES)
+	if (getauxval(AT_HWCAP) & HWCAP_AES) f = aes_ofb_armv8;
+#else
+	f = aes_ofb_armv8;
+#endif
+#endif
+	MYDEBUG(D_ALL) {
+		fprintf(stdout,"# aes_choose(): using the %s kernel\n",
+			f == aes_ofb_portable ? "portable" : "hardware");
+	}
+	return(f);
+}
+
+static void aes_refill (AES_state_t *state) {
+	aes_ofb_t f = __atomic_load_n(&aes_ofb, __ATOMIC_ACQUIRE);
+
+	if (f == 0) {
+		f = aes_choose();
+		__atomic_store_n(&aes_ofb, f, __ATOMIC_RELEASE);
+	}
+	f(state->rk, state->kb, state->out + OUT_SIZE - BLOCKS_SIZE, state->out, OUT_BLOCKS);
+	state->pos = 0;
+}
+
 unsigned long int aes_get (void *vstate) {
 	AES_state_t *state = vstate;
 	unsigned int ret;
 
-	if (state->pos + sizeof(ret) > BLOCKS_SIZE) {
-		rijndaelEncrypt(state->rk, NR, state->block, state->block);
-		state->pos = 0;
+	if (state->pos + sizeof(ret) > OUT_SIZE) {
+		aes_refill(state);
 	}
 
-	ret = *((unsigned int *) (state->block + state->pos));
+	ret = *((unsigned int *) (state->out + state->pos));
 	state->pos += sizeof(ret);
 
 //	ret &= 0x7fffffff;
@@ -56,6 +189,27 @@ unsigned long int aes_get (void *vstate) {
 }
 
 
+/*
+ * Bulk version of aes_get(): copy whole runs of words out of the buffer.
+ */
+void aes_fill (void *vstate, unsigned int *buf, size_t n) {
+	AES_state_t *state = vstate;
+	size_t k;
+
+	while (n) {
+		if (state->pos + sizeof(unsigned int) > OUT_SIZE) {
+			aes_refill(state);
+		}
+		k = (OUT_SIZE - state->pos) / sizeof(unsigned int);
+		if (k > n) k = n;
+		memcpy(buf, state->out + state->pos, k * sizeof(unsigned int));
+		state->pos += k * sizeof(unsigned int);
+		buf += k;
+		n -= k;
+	}
+}
+
+
 double aes_get_double (void *vstate) {
 //	return aes_get_long(vstate) / (double) ULONG_MAX;
 	return (double) aes_get(vstate) / (double) (UINT_MAX >> 0);
@@ -66,7 +220,7 @@ void aes_set (void *vstate, unsigned long int s) {
 	int i;
 	u8 key[16];
 
-	memset(state, 0, sizeof(*state));	// Zero pos and block
+	memset(state, 0, sizeof(*state));	// Zero pos and the state block
 
 	/* Make sure to use all bits of s in the key:
 	 * (5 * i) % 26 => {0,5,10,15,20,25,4,9,14,19,24,3,8,13,18,23}
@@ -75,7 +229,8 @@ void aes_set (void *vstate, unsigned long int s) {
 		key[i] = (u8) (112 + i + (s >> ((5 * i) % 26)));
 	}
 	rijndaelKeySetupEnc(state->rk, key, 128);
-	rijndaelEncrypt(state->rk, NR, state->block, state->block);
+	aes_key_bytes(state->rk, state->kb);
+	aes_refill(state);
 
 	return;
 }
@@ -32,6 +32,15 @@
 
 #include <dieharder/libdieharder.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CA_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__)
+#define CA_ARM 1
+#include <arm_neon.h>
+#endif
+
 /*
  * This is a wrapping of the /dev/random hardware rng
  */
@@ -48,11 +57,10 @@ ca_state_t;
 
 #define CA_WIDTH 2056   // width in cells of cellular automaton
 #define RULESIZE 511    // amount of elements in rule table
+#define CA_WORDS (CA_WIDTH/4)   // 32-bit integers per generation
 
 static unsigned char init_config[CA_WIDTH];  // initial configuration of CA
-static unsigned char * first_cell;           // leftmost cell
-static unsigned char * last_cell;            // rightmost cell
-static unsigned char * cell_d;               // current cell
+static unsigned int ca_pos;                  // next integer of this generation
 
 unsigned int rule[RULESIZE] = {
    100,75,16,3,229,51,197,118,24,62,198,11,141,152,241,188,2,17,71,47,179,177,126,231,202,243,59,25,77,196,30,134,
@@ -74,41 +82,163 @@ unsigned int rule[RULESIZE] = {
    142,119,73,103,166,33,148,9,111,136,168,150,82
 };
 
+/*
+ * The original ca_get() updated the four cells of an integer at a time,
+ * right to left, each from its own old state and that of its left
+ * neighbor, and returned them.  As every cell only ever looks at cells
+ * that have not been updated yet, that is exactly one synchronous
+ * generation of the whole automaton,
+ *
+ *   new[i] = rule[old[i-1] + old[i]] (i > 0),  new[0] = rule[old[0]],
+ *
+ * handed out CA_WORDS integers at a time from the right end (cells
+ * CA_WIDTH-4 to CA_WIDTH-1) to the left, so we compute a generation at
+ * a time instead.  rule[] is the same 256-entry permutation twice over,
+ * so rule[a + b] = rule[(a + b) mod 256], which makes the update pure
+ * byte arithmetic plus a 256-byte table lookup, and that we can do 32
+ * (AVX2) or 16 (NEON) cells at a time with byte shuffles, as 16 (or 4)
+ * lookups in 16 (or 64) byte slices of the table.
+ */
+typedef void (*ca_generation_t)(unsigned char *cells);
+
+static unsigned char ca_rule8[256];
+
+static void ca_generation_portable (unsigned char *cells)
+{
+
+  int i;
+
+  for (i = CA_WIDTH - 1; i > 0; i--)
+    cells[i] = ca_rule8[(unsigned char)(cells[i - 1] + cells[i])];
+  cells[0] = ca_rule8[cells[0]];
+
+}
+
+#ifdef CA_X86
+__attribute__((target("avx2")))
+static void ca_generation_avx2 (unsigned char *cells)
+{
+
+  __m256i t[16], a, b, lo, hi, r;
+  int i, k;
+
+  for (k = 0; k < 16; k++)
+    t[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(ca_rule8 + 16*k)));
+
+  /*
+   * Right to left, so the old left neighbors are still there to read.
+   */
+  for (i = CA_WIDTH - 32; i > 0; i -= 32) {
+    a = _mm256_loadu_si256((const __m256i *)(cells + i - 1));
+    b = _mm256_loadu_si256((const __m256i *)(cells + i));
+    b = _mm256_add_epi8(a, b);
+    lo = _mm256_and_si256(b, _mm256_set1_epi8(0x0f));
+    hi = _mm256_and_si256(_mm256_srli_epi16(b, 4), _mm256_set1_epi8(0x0f));
+    r = _mm256_setzero_si256();
+    for (k = 0; k < 16; k++)
+      r = _mm256_or_si256(r, _mm256_and_si256(_mm256_shuffle_epi8(t[k], lo),
+                                              _mm256_cmpeq_epi8(hi, _mm256_set1_epi8(k))));
+    _mm256_storeu_si256((__m256i *)(cells + i), r);
+  }
+  for (i += 31; i > 0; i--)
+    cells[i] = ca_rule8[(unsigned char)(cells[i - 1] + cells[i])];
+  cells[0] = ca_rule8[cells[0]];
+
+}
+#endif
+
+#ifdef CA_ARM
+static void ca_generation_neon (unsigned char *cells)
+{
+
+  uint8x16x4_t t[4];
+  uint8x16_t s, r;
+  int i, k;
+
+  for (k = 0; k < 4; k++)
+    t[k] = vld1q_u8_x4(ca_rule8 + 64*k);
+
+  for (i = CA_WIDTH - 16; i > 0; i -= 16) {
+    s = vaddq_u8(vld1q_u8(cells + i - 1), vld1q_u8(cells + i));
+    r = vqtbl4q_u8(t[0], s);
+    r = vqtbx4q_u8(r, t[1], vsubq_u8(s, vdupq_n_u8(64)));
+    r = vqtbx4q_u8(r, t[2], vsubq_u8(s, vdupq_n_u8(128)));
+    r = vqtbx4q_u8(r, t[3], vsubq_u8(s, vdupq_n_u8(192)));
+    vst1q_u8(cells + i, r);
+  }
+  for (i += 15; i > 0; i--)
+    cells[i] = ca_rule8[(unsigned char)(cells[i - 1] + cells[i])];
+  cells[0] = ca_rule8[cells[0]];
+
+}
+#endif
+
+/*
+ * Pick the fastest kernel this CPU can run, once.
+ */
+static ca_generation_t ca_generation = 0;
+
+static ca_generation_t ca_choose (void)
+{
+
+  ca_generation_t f = ca_generation_portable;
+  int i;
+
+  for (i = 0; i < 256; i++) ca_rule8[i] = rule[i];
+#ifdef CA_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) f = ca_generation_avx2;
+#endif
+#ifdef CA_ARM
+  f = ca_generation_neon;
+#endif
+  return(f);
+
+}
+
+static inline void ca_next_generation (void)
+{
+
+  if (ca_generation == 0) ca_generation = ca_choose();
+  ca_generation(init_config);
+  ca_pos = 0;
+
+}
+
+/*
+ * The k'th integer of the current generation.
+ */
+static inline unsigned int ca_word (unsigned int k)
+{
+
+  unsigned int w;
+
+  memcpy(&w, init_config + CA_WIDTH - 4 - 4*k, sizeof(w));
+  return(w);
+
+}
+
 static inline unsigned long int
 ca_get (void *vstate)
 {
   /* Returns a 32-bit unsigned integer produced by the automaton */
 
-  /*
-   * cell addresses (these cells and cell_d serve as pointers to the 4
-   * bytes of the next integer)
-   */
-  unsigned char * cell_a;
-  unsigned char * cell_b;
-  unsigned char * cell_c;
+  if (ca_pos == CA_WORDS) ca_next_generation();
+  return( ca_word(ca_pos++) );
+
+}
 
-  /* set cell addresses using address of current cell (cell_d) */
-  cell_c = cell_d - 1; 
-  cell_b = cell_c - 1; 
-  cell_a = cell_b - 1; 
+/*
+ * ca_get() n times.
+ */
+void ca_fill (void *vstate, unsigned int *buf, size_t n)
+{
 
-  /* update cell states using rule table */
-  *cell_d = rule[*cell_c + *cell_d]; 
-  *cell_c = rule[*cell_b + *cell_c]; 
-  *cell_b = rule[*cell_a + *cell_b]; 
+  size_t i = 0;
 
-  /*
-   * update the state of cell_a and shift current cell (cell_d) to the
-   * left by 4 bytes (first_cell - 1 = last_cell)
-   */
-  if (cell_a == first_cell) {
-    *cell_a = rule[*cell_a]; 
-    cell_d = last_cell; 
-    return( *((unsigned int *)cell_a) ); 
-  } else { 
-    *cell_a = rule[*(cell_a - 1) + *cell_a];
-    cell_d -= 4; 
-    return( *((unsigned int *)cell_a) ); 
+  while (i < n) {
+    if (ca_pos == CA_WORDS) ca_next_generation();
+    while (i < n && ca_pos < CA_WORDS) buf[i++] = ca_word(ca_pos++);
   }
 
 }
@@ -143,19 +273,13 @@ ca_set (void *vstate, unsigned long int s) {
    for (i = 0; i < CA_WIDTH - 4; i++) 
      init_config[i] = (unsigned char) ( seed >> (i % 32) );
 
-   /* define addresses of first_cell and last_cell */
-   first_cell = init_config;
-   last_cell = init_config + CA_WIDTH - 1;
-
    /*
-    * set address of current cell to last_cell (automaton is updated right
-    * to left)
+    * evolve automaton before returning integers (CA_WIDTH generations,
+    * as many as the CA_WIDTH*CA_WIDTH/4 ca_get() calls this used to be)
     */
-   cell_d = last_cell;
-
-   /* evolve automaton before returning integers */
-   for (i = 0 ; i < ( (CA_WIDTH * CA_WIDTH) / 4.0); i++) 
-      ca_get(vstate);
+   for (i = 0 ; i < CA_WIDTH; i++) 
+      ca_next_generation();
+   ca_pos = CA_WORDS;
 
 }
 
@@ -0,0 +1,201 @@
+/*
+ *  rng_chacha20.c
+ *
+ *  The ChaCha20 stream cipher as a generator, from:
+ *
+ * D. J. Bernstein, "ChaCha, a variant of Salsa20" (2008),
+ *
+ * in its original form with a 64 bit block counter and a 64 bit nonce.
+ * The 256 bit key is expanded from the seed with splitmix64_next(), the
+ * output is the keystream as little endian uints, and the nonce is the
+ * substream number, so there are 2^64 substreams of 2^70 bytes each.
+ *
+ * Blocks are made CHACHA_WAYS at a time, each lane of a vector holding
+ * the same word of a different block, which GCC and clang turn into
+ * SSE2/AVX2/NEON code wherever the target has it (and into plain
+ * scalar code where it doesn't).
+ */
+
+#include <dieharder/libdieharder.h>
+
+static unsigned long int chacha20_get (void *vstate);
+static double chacha20_get_double (void *vstate);
+static void chacha20_set (void *vstate, unsigned long int s);
+
+#define CHACHA_WAYS 4                           /* Blocks per refill */
+#define CHACHA_BLOCK 16                         /* uints per block */
+#define CHACHA_OUT (CHACHA_WAYS*CHACHA_BLOCK)
+
+typedef struct {
+ uint32_t key[8];
+ uint64_t block;        /* The next block */
+ uint64_t nonce;        /* The substream */
+ uint32_t out[CHACHA_OUT];      /* The last CHACHA_WAYS blocks... */
+ unsigned int pos;              /* ...and their next unused uint */
+} chacha20_state_t;
+
+#define ROTL32(x,n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define QR(a,b,c,d) \
+ a += b; d ^= a; d = ROTL32(d,16); \
+ c += d; b ^= c; b = ROTL32(b,12); \
+ a += b; d ^= a; d = ROTL32(d,8); \
+ c += d; b ^= c; b = ROTL32(b,7);
+
+#if defined(__GNUC__)
+typedef uint32_t chacha_vec __attribute__ ((vector_size (CHACHA_WAYS*4)));
+#endif
+
+/*
+ * Blocks block,...,block+CHACHA_WAYS-1 of the keystream, one after the
+ * other, into out.
+ */
+static void chacha20_blocks(const chacha20_state_t *state, uint64_t block, uint32_t *out)
+{
+
+ uint32_t in[CHACHA_BLOCK];
+ int i,j,r;
+
+ in[0] = 0x61707865;
+ in[1] = 0x3320646e;
+ in[2] = 0x79622d32;
+ in[3] = 0x6b206574;
+ for(i = 0;i < 8;i++) in[4 + i] = state->key[i];
+ in[14] = (uint32_t) state->nonce;
+ in[15] = state->nonce >> 32;
+
+#if defined(__GNUC__)
+ {
+   chacha_vec x[CHACHA_BLOCK],x0[CHACHA_BLOCK];
+
+   for(i = 0;i < CHACHA_BLOCK;i++){
+     for(j = 0;j < CHACHA_WAYS;j++) x0[i][j] = in[i];
+   }
+   for(j = 0;j < CHACHA_WAYS;j++){
+     x0[12][j] = (uint32_t)(block + j);
+     x0[13][j] = (block + j) >> 32;
+   }
+   for(i = 0;i < CHACHA_BLOCK;i++) x[i] = x0[i];
+   for(r = 0;r < 10;r++){
+     QR(x[0],x[4],x[8],x[12]);
+     QR(x[1],x[5],x[9],x[13]);
+     QR(x[2],x[6],x[10],x[14]);
+     QR(x[3],x[7],x[11],x[15]);
+     QR(x[0],x[5],x[10],x[15]);
+     QR(x[1],x[6],x[11],x[12]);
+     QR(x[2],x[7],x[8],x[13]);
+     QR(x[3],x[4],x[9],x[14]);
+   }
+   for(i = 0;i < CHACHA_BLOCK;i++){
+     x[i] += x0[i];
+     for(j = 0;j < CHACHA_WAYS;j++) out[j*CHACHA_BLOCK + i] = x[i][j];
+   }
+ }
+#else
+ for(j = 0;j < CHACHA_WAYS;j++){
+   uint32_t x[CHACHA_BLOCK];
+
+   in[12] = (uint32_t)(block + j);
+   in[13] = (block + j) >> 32;
+   for(i = 0;i < CHACHA_BLOCK;i++) x[i] = in[i];
+   for(r = 0;r < 10;r++){
+     QR(x[0],x[4],x[8],x[12]);
+     QR(x[1],x[5],x[9],x[13]);
+     QR(x[2],x[6],x[10],x[14]);
+     QR(x[3],x[7],x[11],x[15]);
+     QR(x[0],x[5],x[10],x[15]);
+     QR(x[1],x[6],x[11],x[12]);
+     QR(x[2],x[7],x[8],x[13]);
+     QR(x[3],x[4],x[9],x[14]);
+   }
+   for(i = 0;i < CHACHA_BLOCK;i++) out[j*CHACHA_BLOCK + i] = x[i] + in[i];
+ }
+#endif
+
+}
+
+static unsigned long int chacha20_get (void *vstate)
+{
+
+ chacha20_state_t *state = vstate;
+
+ if(state->pos == CHACHA_OUT){
+   chacha20_blocks(state,state->block,state->out);
+   state->block += CHACHA_WAYS;
+   state->pos = 0;
+ }
+ return state->out[state->pos++];
+
+}
+
+/*
+ * chacha20_get() n times.  Whole refills go straight into buf.
+ */
+void chacha20_fill (void *vstate, unsigned int *buf, size_t n)
+{
+
+ chacha20_state_t *state = vstate;
+
+ while(n && state->pos < CHACHA_OUT){
+   *buf++ = state->out[state->pos++];
+   n--;
+ }
+ for(;n >= CHACHA_OUT;n -= CHACHA_OUT){
+   chacha20_blocks(state,state->block,buf);
+   state->block += CHACHA_WAYS;
+   buf += CHACHA_OUT;
+ }
+ if(n){
+   chacha20_blocks(state,state->block,state->out);
+   state->block += CHACHA_WAYS;
+   memcpy(buf,state->out,n*sizeof(unsigned int));
+   state->pos = n;
+ }
+
+}
+
+static double chacha20_get_double (void *vstate)
+{
+  return (double) chacha20_get (vstate) / (double) UINT_MAX;
+}
+
+static void chacha20_set (void *vstate, unsigned long int s)
+{
+
+ chacha20_state_t *state = vstate;
+ uint64_t x = s,k;
+ int i;
+
+ for(i = 0;i < 4;i++){
+   k = splitmix64_next(&x);
+   state->key[2*i] = (uint32_t) k;
+   state->key[2*i + 1] = k >> 32;
+ }
+ state->block = 0;
+ state->nonce = 0;
+ state->pos = CHACHA_OUT;
+
+}
+
+/*
+ * Seed with seed and select substream k (see above).
+ */
+void chacha20_substream (void *vstate, unsigned long int seed, unsigned long int k)
+{
+
+ chacha20_state_t *state = vstate;
+
+ chacha20_set(vstate,seed);
+ state->nonce = k;
+
+}
+
+static const gsl_rng_type chacha20_type =
+{"chacha20",			/* name */
+ UINT_MAX,			/* RAND_MAX */
+ 0,				/* RAND_MIN */
+ sizeof (chacha20_state_t),
+ &chacha20_set,
+ &chacha20_get,
+ &chacha20_get_double};
+
+const gsl_rng_type *gsl_rng_chacha20 = &chacha20_type;
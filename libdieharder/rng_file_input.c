@@ -14,6 +14,8 @@
  */
 
 #include <dieharder/libdieharder.h>
+#include <ctype.h>
+#include <float.h>
 
 /*
  * This is a wrapper for getting random numbers from a file.  Note
@@ -37,6 +39,8 @@ static void file_input_set (void *vstate, unsigned long int s);
  *      was deliberately reset.
  *   rewind_cnt is a count of how many times the file was rewound since
  *      its last open.
+ *   ibuf is the read buffer for the data lines, ipos the next unread char
+ *      in it and ilen the number of chars in it.
  *
  * file_input_state_t is defined in libdieharder.h currently and shared with
  * file_input_raw.c
@@ -66,13 +70,283 @@ file_input_set_rtot(gsl_rng *rng,uint value)
   state->rtot = 0;
 }
 
+/*
+ * The data lines are read through a large buffer (FI_BUFSIZE chars,
+ * refilled with one fread() at a time) instead of an fgets() per line,
+ * and the common cases of each conversion are done by hand.  Anything
+ * the hand conversion isn't CERTAIN to get exactly the way sscanf()
+ * would (signs, overflow, long or odd floats, trailing junk...) is
+ * simply handed to sscanf(), so the rands are the same as ever.  Blank
+ * lines and lines starting with # are skipped (and not counted).
+ */
+#define FI_BUFSIZE 1048576
+
+/*
+ * Return the next line of the file, without its newline, or 0 at EOF.
+ * Like fgets(inbuf,K,fp), we split lines longer than K-1 chars.
+ */
+static char *file_input_line(file_input_state_t *state)
+{
+
+ char *nl,*line;
+ size_t n,got;
+
+ if(state->ibuf == NULL){
+   /*
+    * Room for the buffer, its terminating NUL and the copy of a split
+    * line (which also keeps bit2uint() inside the allocation).
+    */
+   state->ibuf = (char *)malloc(FI_BUFSIZE + 1 + K);
+   if(state->ibuf == NULL){
+     fprintf(stderr,"# file_input(): Error: Cannot allocate input buffer.\n");
+     exit(0);
+   }
+   memset(state->ibuf,0,FI_BUFSIZE + 1 + K);
+   state->ipos = state->ilen = 0;
+ }
+
+ while(1){
+   n = state->ilen - state->ipos;
+   line = state->ibuf + state->ipos;
+   nl = (char *)memchr(line,'\n',n < K-1 ? n : K-1);
+   if(nl){
+     *nl = '\0';
+     state->ipos += nl - line + 1;
+     return(line);
+   }
+   if(n >= K-1){
+     memcpy(state->ibuf + FI_BUFSIZE + 1,line,K-1);
+     state->ibuf[FI_BUFSIZE + K] = '\0';
+     state->ipos += K-1;
+     return(state->ibuf + FI_BUFSIZE + 1);
+   }
+   memmove(state->ibuf,line,n);
+   state->ipos = 0;
+   state->ilen = n;
+   got = fread(state->ibuf + n,1,FI_BUFSIZE - n,state->fp);
+   state->ilen += got;
+   if(got == 0){
+     if(n == 0) return(0);
+     state->ibuf[n] = '\0';
+     state->ipos = state->ilen;
+     return(state->ibuf);
+   }
+ }
+
+}
+
+/*
+ * sscanf(line,"%u"/"%o"/"%x",&iret) for a plain unsigned number that
+ * fits in an unsigned long and is followed by whitespace or the end of
+ * the line.  Returns 0 if the line isn't that simple.
+ */
+static int file_input_strtou(const char *p,unsigned int base,unsigned int *iret)
+{
+
+ unsigned long v;
+ unsigned int d;
+ int any;
+
+ while(*p == ' ' || *p == '\t' || *p == '\r') p++;
+ any = 0;
+ if(base == 16 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')){
+   any = 1;
+   p += 2;
+ }
+ v = 0;
+ while(1){
+   if(*p >= '0' && *p <= '9'){
+     d = *p - '0';
+   } else if(base == 16 && *p >= 'a' && *p <= 'f'){
+     d = *p - 'a' + 10;
+   } else if(base == 16 && *p >= 'A' && *p <= 'F'){
+     d = *p - 'A' + 10;
+   } else {
+     break;
+   }
+   if(d >= base) break;
+   if(v > (ULONG_MAX - d)/base) return(0);
+   v = v*base + d;
+   any = 1;
+   p++;
+ }
+ if(!any || (*p != '\0' && !isspace((unsigned char) *p))) return(0);
+ *iret = (unsigned int) v;
+ return(1);
+
+}
+
+/*
+ * sscanf(line,"%lg",&f) for a plain decimal float with at most 19
+ * significant digits.  When the digits fit in a double and the power of
+ * ten is exact (|e| <= 22) one multiply or divide rounds correctly
+ * (Clinger's fast path), which is what strtod() returns.  Returns 0 if
+ * the line isn't that simple or the arithmetic isn't plain double.
+ */
+static int file_input_strtod(const char *p,double *f)
+{
+
+ static const double p10[] = {
+   1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+   1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22
+ };
+ uint64_t m;
+ int neg,nd,e,ex,exneg,any;
+
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD != 0
+ return(0);
+#endif
+ while(*p == ' ' || *p == '\t' || *p == '\r') p++;
+ neg = 0;
+ if(*p == '-' || *p == '+'){
+   neg = (*p == '-');
+   p++;
+ }
+ m = 0;
+ nd = 0;
+ e = 0;
+ any = 0;
+ while(*p >= '0' && *p <= '9'){
+   if(m || *p != '0'){
+     if(++nd > 19) return(0);
+     m = 10*m + (*p - '0');
+   }
+   any = 1;
+   p++;
+ }
+ if(*p == '.'){
+   p++;
+   while(*p >= '0' && *p <= '9'){
+     if(m || *p != '0'){
+       if(++nd > 19) return(0);
+       m = 10*m + (*p - '0');
+     }
+     e--;
+     any = 1;
+     p++;
+   }
+ }
+ if(!any) return(0);
+ if(*p == 'e' || *p == 'E'){
+   p++;
+   exneg = 0;
+   if(*p == '-' || *p == '+'){
+     exneg = (*p == '-');
+     p++;
+   }
+   if(*p < '0' || *p > '9') return(0);
+   ex = 0;
+   while(*p >= '0' && *p <= '9'){
+     if(ex > 1000) return(0);
+     ex = 10*ex + (*p - '0');
+     p++;
+   }
+   e += exneg ? -ex : ex;
+ }
+ if(*p != '\0' && !isspace((unsigned char) *p)) return(0);
+ if(m > ((uint64_t) 1 << 53)) return(0);
+ if(m == 0){
+   *f = 0.0;
+ } else if(e >= 0 && e <= 22){
+   *f = (double) m*p10[e];
+ } else if(e < 0 && e >= -22){
+   *f = (double) m/p10[-e];
+ } else {
+   return(0);
+ }
+ if(neg) *f = -*f;
+ return(1);
+
+}
+
+/*
+ * Convert a data line into a uint according to the "type" (basically
+ * matching scanf type).
+ */
+static unsigned int file_input_convert(char *inbuf)
+{
+
+ unsigned int iret;
+ double f;
+
+ switch(filetype){
+   /*
+    * 32 bit unsigned int by assumption
+    */
+   case 'd':
+   case 'i':
+   case 'u':
+     if(file_input_strtou(inbuf,10,&iret)) break;
+     if(0 == sscanf(inbuf,"%u",&iret)){
+       fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
+       exit(0);
+     }
+     break;
+   /*
+    * double precision floats get converted to 32 bit uint
+    */
+   case 'e':
+   case 'E':
+   case 'f':
+   case 'F':
+   case 'g':
+     if(!file_input_strtod(inbuf,&f) && 0 == sscanf(inbuf,"%lg",&f)){
+       fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
+       exit(0);
+     }
+     iret = (uint) f*UINT_MAX;
+     break;
+   /*
+    * OK, so octal is really pretty silly, but we got it.  Still uint.
+    */
+   case 'o':
+     if(file_input_strtou(inbuf,8,&iret)) break;
+     if(0 == sscanf(inbuf,"%o",&iret)){
+       fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
+       exit(0);
+     }
+     break;
+   /*
+    * hexadecimal is silly too, but we got it.  uint, of course.
+    */
+   case 'x':
+     if(file_input_strtou(inbuf,16,&iret)) break;
+     if(0 == sscanf(inbuf,"%x",&iret)){
+       fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
+       exit(0);
+     }
+     break;
+   case 'X':
+     if(file_input_strtou(inbuf,16,&iret)) break;
+     if(0 == sscanf(inbuf,"%X",&iret)){
+       fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
+       exit(0);
+     }
+     break;
+   /*
+    * binary is NOT so silly.  Let's do it.  The hard way.  A typical
+    * entry should look like:
+    *    01110101001010100100111101101110
+    */
+   case 'b':
+     iret = bit2uint(inbuf,filenumbits);
+     break;
+   default:
+     fprintf(stderr,"# file_input(): Error. File type %c is not recognized.\n",filetype);
+     exit(0);
+     break;
+ }
+
+ return(iret);
+
+}
+
 static unsigned long int file_input_get (void *vstate)
 {
 
  file_input_state_t *state = (file_input_state_t *) vstate;
  unsigned int iret;
- double f;
- char inbuf[K]; /* input buffer */
+ char *inbuf,*p;
 
  /*
   * Check that the file is open (via file_input_set()).
@@ -80,80 +354,19 @@ static unsigned long int file_input_get (void *vstate)
  if(state->fp != NULL) {
 
    /*
-    * Read in the next random number from the file
+    * Read in the next random number from the file, skipping blank and
+    * comment lines.
     */
-   if(fgets(inbuf,K,state->fp) == 0){
-     fprintf(stderr,"# file_input(): Error: EOF on %s\n",filename);
-     exit(0);
-   }
-   /*
-    * Got one (as we pretty much have to unless the file is badly
-    * broken).  Convert the STRING input above into a uint according to
-    * the "type" (basically matching scanf type).
-    */
-   switch(filetype){
-     /*
-      * 32 bit unsigned int by assumption
-      */
-     case 'd':
-     case 'i':
-     case 'u':
-       if(0 == sscanf(inbuf,"%u",&iret)){
-         fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
-         exit(0);
-       }
-       break;
-     /*
-      * double precision floats get converted to 32 bit uint
-      */
-     case 'e':
-     case 'E':
-     case 'f':
-     case 'F':
-     case 'g':
-       if(0 == sscanf(inbuf,"%lg",&f)){
-         fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
-         exit(0);
-       }
-       iret = (uint) f*UINT_MAX;
-       break;
-     /*
-      * OK, so octal is really pretty silly, but we got it.  Still uint.
-      */
-     case 'o':
-       if(0 == sscanf(inbuf,"%o",&iret)){
-         fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
-         exit(0);
-       }
-       break;
-     /*
-      * hexadecimal is silly too, but we got it.  uint, of course.
-      */
-     case 'x':
-       if(0 == sscanf(inbuf,"%x",&iret)){
-         fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
-         exit(0);
-       }
-       break;
-     case 'X':
-       if(0 == sscanf(inbuf,"%X",&iret)){
-         fprintf(stderr,"Error: converting %s failed.  Exiting.\n", inbuf);
-         exit(0);
-       }
-       break;
-     /*
-      * binary is NOT so silly.  Let's do it.  The hard way.  A typical
-      * entry should look like:
-      *    01110101001010100100111101101110
-      */
-     case 'b':
-       iret = bit2uint(inbuf,filenumbits);
-       break;
-     default:
-       fprintf(stderr,"# file_input(): Error. File type %c is not recognized.\n",filetype);
+   while(1){
+     if((inbuf = file_input_line(state)) == 0){
+       fprintf(stderr,"# file_input(): Error: EOF on %s\n",filename);
        exit(0);
-       break;
+     }
+     p = inbuf;
+     while(isspace((unsigned char) *p)) p++;
+     if(*p != '\0' && *p != '#') break;
    }
+   iret = file_input_convert(inbuf);
 
    /*
     * Success. iret is presumably valid and ready to return.  Increment the
@@ -183,6 +396,18 @@ static unsigned long int file_input_get (void *vstate)
 
 }
 
+/*
+ * Bulk version of file_input_get(), a buffer of lines at a time.
+ */
+void file_input_fill(void *vstate,unsigned int *buf,size_t n)
+{
+
+ size_t i;
+
+ for(i=0;i<n;i++) buf[i] = file_input_get(vstate);
+
+}
+
 static double file_input_get_double (void *vstate)
 {
   return file_input_get (vstate) / (double) UINT_MAX;
@@ -248,6 +473,7 @@ static void file_input_set (void *vstate, unsigned long int s)
      fprintf(stdout,"# file_input(): Parsing header:\n");
    }
    state->rptr = 0;  /* No rands read yet */
+   state->ipos = state->ilen = 0;
    /*
     * We only reset the entire file if there is a nonzero seed passed in.
     * This clears both rtot and rewind_cnt in addition to rptr.
@@ -267,6 +493,7 @@ static void file_input_set (void *vstate, unsigned long int s)
    if(state->rptr >= state->flen){
      rewind(state->fp);
      state->rptr = 0;
+     state->ipos = state->ilen = 0;
      state->rewind_cnt++;
      if(verbose == D_FILE_INPUT || verbose == D_ALL){
        fprintf(stderr,"# file_input(): Rewinding %s at rtot = %u\n", filename,(uint) state->rtot);
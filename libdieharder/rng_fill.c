@@ -0,0 +1,215 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * The bulk fill interface.  A gsl_rng_type has no room for a block
+ * routine, so generators that have one register it here against their
+ * type (see dieharder_rng_types()), and dh_rng_fill() looks it up.  The
+ * table is only written at startup, so any number of threads can fill
+ * from their own generators at once.
+ *
+ * Generators with 64 bit outputs register a 64 bit fill as well, used by
+ * dh_rng_fill64().
+ *
+ * Generators that can be split into provably disjoint substreams (by
+ * jumping ahead or by a stream/counter/nonce word) likewise register a
+ * substream routine, used by dh_rng_substream().
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+static struct {
+  const gsl_rng_type *type;
+  dh_rng_fill_t fill;
+} dh_fills[DH_MAXFILLS];
+static unsigned int dh_num_fills = 0;
+
+static struct {
+  const gsl_rng_type *type;
+  dh_rng_fill64_t fill64;
+} dh_fill64s[DH_MAXFILLS];
+static unsigned int dh_num_fill64s = 0;
+
+static struct {
+  const gsl_rng_type *type;
+  dh_rng_substream_t substream;
+} dh_substreams[DH_MAXFILLS];
+static unsigned int dh_num_substreams = 0;
+
+/*
+ * Register (or replace) the native fill routine of type.
+ */
+void dh_rng_fill_register(const gsl_rng_type *type,dh_rng_fill_t fill)
+{
+
+ unsigned int i;
+
+ for(i=0;i<dh_num_fills;i++){
+   if(dh_fills[i].type == type){
+     dh_fills[i].fill = fill;
+     return;
+   }
+ }
+ if(dh_num_fills == DH_MAXFILLS){
+   fprintf(stderr,"Error: dh_rng_fill_register() cannot register more than %u fill routines.\n",DH_MAXFILLS);
+   exit(1);
+ }
+ dh_fills[dh_num_fills].type = type;
+ dh_fills[dh_num_fills].fill = fill;
+ dh_num_fills++;
+
+ MYDEBUG(D_TYPES){
+   printf("# dh_rng_fill_register(): %s has a native fill.\n",type->name);
+ }
+
+}
+
+dh_rng_fill_t dh_rng_fill_lookup(const gsl_rng_type *type)
+{
+
+ unsigned int i;
+
+ for(i=0;i<dh_num_fills;i++){
+   if(dh_fills[i].type == type) return(dh_fills[i].fill);
+ }
+ return(0);
+
+}
+
+void dh_rng_fill(gsl_rng *rng,unsigned int *buf,size_t n)
+{
+
+ size_t i;
+ dh_rng_fill_t fill;
+
+ if(n == 0) return;
+ if(n == 1){
+   buf[0] = gsl_rng_get(rng);
+   return;
+ }
+ fill = dh_rng_fill_lookup(rng->type);
+ if(fill){
+   fill(rng->state,buf,n);
+ } else {
+   for(i=0;i<n;i++) buf[i] = gsl_rng_get(rng);
+ }
+
+}
+
+/*
+ * Register (or replace) the native 64 bit fill routine of type.
+ */
+void dh_rng_fill64_register(const gsl_rng_type *type,dh_rng_fill64_t fill64)
+{
+
+ unsigned int i;
+
+ for(i=0;i<dh_num_fill64s;i++){
+   if(dh_fill64s[i].type == type){
+     dh_fill64s[i].fill64 = fill64;
+     return;
+   }
+ }
+ if(dh_num_fill64s == DH_MAXFILLS){
+   fprintf(stderr,"Error: dh_rng_fill64_register() cannot register more than %u fill routines.\n",DH_MAXFILLS);
+   exit(1);
+ }
+ dh_fill64s[dh_num_fill64s].type = type;
+ dh_fill64s[dh_num_fill64s].fill64 = fill64;
+ dh_num_fill64s++;
+
+ MYDEBUG(D_TYPES){
+   printf("# dh_rng_fill64_register(): %s has a native 64 bit fill.\n",type->name);
+ }
+
+}
+
+/*
+ * The next n 64 bit words of rng:  whole returns of generators with a
+ * native 64 bit fill (or with returns wider than 32 bits), and pairs of
+ * uints, the first in the low half, from everything else -- which is
+ * how the 64 bit generators hand out their returns as uints anyway.
+ */
+void dh_rng_fill64(gsl_rng *rng,uint64_t *buf,size_t n)
+{
+
+ size_t i;
+ unsigned int w[2];
+
+ for(i=0;i<dh_num_fill64s;i++){
+   if(dh_fill64s[i].type == rng->type){
+     dh_fill64s[i].fill64(rng->state,buf,n);
+     return;
+   }
+ }
+ if(gsl_rng_max(rng) > UINT_MAX){
+   for(i=0;i<n;i++) buf[i] = gsl_rng_get(rng);
+   return;
+ }
+
+ /*
+  * Fill the words as 2n uints, then put each pair (which occupies just
+  * the word it becomes) together in place.
+  */
+ dh_rng_fill(rng,(unsigned int *) buf,2*n);
+ for(i=0;i<n;i++){
+   memcpy(w,&buf[i],sizeof(w));
+   buf[i] = (uint64_t) w[0] | ((uint64_t) w[1] << 32);
+ }
+
+}
+
+/*
+ * Register (or replace) the substream routine of type.
+ */
+void dh_rng_substream_register(const gsl_rng_type *type,dh_rng_substream_t substream)
+{
+
+ unsigned int i;
+
+ for(i=0;i<dh_num_substreams;i++){
+   if(dh_substreams[i].type == type){
+     dh_substreams[i].substream = substream;
+     return;
+   }
+ }
+ if(dh_num_substreams == DH_MAXFILLS){
+   fprintf(stderr,"Error: dh_rng_substream_register() cannot register more than %u substream routines.\n",DH_MAXFILLS);
+   exit(1);
+ }
+ dh_substreams[dh_num_substreams].type = type;
+ dh_substreams[dh_num_substreams].substream = substream;
+ dh_num_substreams++;
+
+ MYDEBUG(D_TYPES){
+   printf("# dh_rng_substream_register(): %s has substreams.\n",type->name);
+ }
+
+}
+
+/*
+ * Seed rng with seed and move it to the start of its k'th substream.
+ * Substreams of one seed never overlap (see the generator for how long
+ * they are).  Returns 0, leaving rng alone, if rng's type cannot do
+ * this; the caller then usually falls back on
+ * gsl_rng_set(rng,dh_seed_derive(seed,k)).
+ */
+int dh_rng_substream(gsl_rng *rng,unsigned long int seed,unsigned long int k)
+{
+
+ unsigned int i;
+
+ for(i=0;i<dh_num_substreams;i++){
+   if(dh_substreams[i].type == rng->type){
+     dh_substreams[i].substream(rng->state,seed,k);
+     return(1);
+   }
+ }
+ return(0);
+
+}
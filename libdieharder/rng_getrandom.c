@@ -0,0 +1,316 @@
+/*
+ * getrandom
+ */
+
+#include <dieharder/libdieharder.h>
+#include <errno.h>
+#include <pthread.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+/*
+ * This is a wrapping of the kernel CSPRNG (the one behind /dev/urandom)
+ * through the getrandom(2) system call, which needs no open file and no
+ * stdio.  Where the dev_urandom generator does an fread() per return,
+ * we ask for GR_BUF uints at a time and hand them out of a buffer, and
+ * getrandom_fill() asks for everything it is asked for in one (or a few)
+ * system calls straight into the caller's buffer.
+ *
+ * getrandom_prefetch is the same source read ahead by a helper thread
+ * into a ring of GR_NBLOCKS blocks of GR_BLOCK uints (see
+ * rng_stdin_input_raw.c), so that the tests only take a lock once per
+ * block and never wait on a system call unless they outrun the kernel.
+ * Every instance has its own ring and thread, started on the first get.
+ * A gsl_rng has no destructor, so instances must be freed with
+ * dh_rng_free(), which stops and joins the thread and frees the ring
+ * (see getrandom_prefetch_free()); gsl_rng_free() alone leaks both.
+ *
+ * The seed means nothing to either.
+ */
+
+static unsigned long int getrandom_get (void *vstate);
+static double getrandom_get_double (void *vstate);
+static void getrandom_set (void *vstate, unsigned long int s);
+static unsigned long int getrandom_prefetch_get (void *vstate);
+static double getrandom_prefetch_get_double (void *vstate);
+static void getrandom_prefetch_set (void *vstate, unsigned long int s);
+
+#define GR_BUF 16384            /* uints per direct refill (64 KB) */
+#define GR_CHUNK (1 << 20)      /* bytes per getrandom() call at most */
+#define GR_BLOCK 262144         /* uints per ring block (1 MB) */
+#define GR_NBLOCKS 4
+
+typedef struct {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  pthread_t thread;
+  unsigned int *buf;            /* GR_NBLOCKS blocks of GR_BLOCK uints */
+  unsigned long head;           /* blocks filled by the thread */
+  unsigned long tail;           /* blocks used up by the tests */
+  int stop;                     /* Set to make the thread exit */
+} gr_ring_t;
+
+typedef struct
+  {
+    unsigned int buf[GR_BUF];   /* Direct: the last refill */
+    gr_ring_t *ring;            /* Prefetch: the ring... */
+    unsigned int *cur;          /* ...the block being used up */
+    size_t pos,n;               /* Next uint of buf or cur, and its length */
+  }
+getrandom_state_t;
+
+/*
+ * Fill buf with n random bytes, however many calls it takes.  getrandom()
+ * on the urandom source only returns short (or fails with EINTR) when a
+ * signal interrupts a large request, so we just go on.
+ */
+static void gr_bytes (void *buf, size_t n)
+{
+
+  unsigned char *p = (unsigned char *) buf;
+  long r;
+
+  while (n) {
+#if defined(__linux__) && defined(SYS_getrandom)
+    r = syscall(SYS_getrandom, p, n < GR_CHUNK ? n : GR_CHUNK, 0);
+#else
+    r = -1;
+    errno = ENOSYS;
+#endif
+    if (r < 0) {
+      if (errno == EINTR) continue;
+      fprintf(stderr,"Error: getrandom() failed: %s.  Exiting.\n",strerror(errno));
+      exit(0);
+    }
+    p += r;
+    n -= r;
+  }
+
+}
+
+/*
+ * Nonzero if this system has getrandom(2), so that the generators are
+ * only listed where they work.
+ */
+int getrandom_available (void)
+{
+
+#if defined(__linux__) && defined(SYS_getrandom)
+  unsigned int probe;
+
+  return (syscall(SYS_getrandom, &probe, sizeof(probe), 0) == sizeof(probe));
+#else
+  return 0;
+#endif
+
+}
+
+static unsigned long int
+getrandom_get (void *vstate)
+{
+  getrandom_state_t *state = (getrandom_state_t *) vstate;
+
+  if (state->pos == GR_BUF) {
+      gr_bytes(state->buf, sizeof(state->buf));
+      state->pos = 0;
+  }
+  return state->buf[state->pos++];
+}
+
+/*
+ * Bulk version of getrandom_get():  what is left of the buffer, and
+ * then the rest straight from the kernel.
+ */
+void
+getrandom_fill (void *vstate, unsigned int *buf, size_t n)
+{
+  getrandom_state_t *state = (getrandom_state_t *) vstate;
+  size_t k;
+
+  k = GR_BUF - state->pos;
+  if (k > n) k = n;
+  memcpy(buf, &state->buf[state->pos], k*sizeof(unsigned int));
+  state->pos += k;
+  if (n > k) gr_bytes(buf + k, (n - k)*sizeof(unsigned int));
+}
+
+static void *gr_reader (void *arg)
+{
+
+  gr_ring_t *ring = (gr_ring_t *) arg;
+  unsigned int *block;
+
+  while (1) {
+    pthread_mutex_lock(&ring->mutex);
+    while (ring->head - ring->tail == GR_NBLOCKS && !ring->stop) {
+      pthread_cond_wait(&ring->cond, &ring->mutex);
+    }
+    if (ring->stop) {
+      pthread_mutex_unlock(&ring->mutex);
+      break;
+    }
+    block = &ring->buf[(ring->head % GR_NBLOCKS)*GR_BLOCK];
+    pthread_mutex_unlock(&ring->mutex);
+
+    gr_bytes(block, GR_BLOCK*sizeof(unsigned int));
+
+    pthread_mutex_lock(&ring->mutex);
+    ring->head++;
+    pthread_cond_broadcast(&ring->cond);
+    pthread_mutex_unlock(&ring->mutex);
+  }
+  return(0);
+
+}
+
+/*
+ * Trade the block we have used up for the next full one, starting the
+ * ring if this is the first call.
+ */
+static void gr_next (getrandom_state_t *state)
+{
+
+  gr_ring_t *ring = state->ring;
+
+  if (ring == 0) {
+    ring = (gr_ring_t *) malloc(sizeof(gr_ring_t));
+    ring->buf = (unsigned int *) malloc((size_t) GR_NBLOCKS*GR_BLOCK*sizeof(unsigned int));
+    ring->head = ring->tail = 0;
+    ring->stop = 0;
+    pthread_mutex_init(&ring->mutex, NULL);
+    pthread_cond_init(&ring->cond, NULL);
+    if (ring->buf == 0 || pthread_create(&ring->thread, NULL, gr_reader, ring) != 0) {
+      fprintf(stderr,"Error: getrandom_prefetch cannot start its reader.  Exiting.\n");
+      exit(0);
+    }
+    state->ring = ring;
+  }
+
+  pthread_mutex_lock(&ring->mutex);
+  if (state->cur) {
+    ring->tail++;
+    pthread_cond_broadcast(&ring->cond);
+  }
+  while (ring->head == ring->tail) {
+    pthread_cond_wait(&ring->cond, &ring->mutex);
+  }
+  state->cur = &ring->buf[(ring->tail % GR_NBLOCKS)*GR_BLOCK];
+  pthread_mutex_unlock(&ring->mutex);
+  state->n = GR_BLOCK;
+  state->pos = 0;
+
+}
+
+static unsigned long int
+getrandom_prefetch_get (void *vstate)
+{
+  getrandom_state_t *state = (getrandom_state_t *) vstate;
+
+  if (state->pos == state->n) gr_next(state);
+  return state->cur[state->pos++];
+}
+
+/*
+ * Bulk version of getrandom_prefetch_get(), straight out of the blocks.
+ */
+void
+getrandom_prefetch_fill (void *vstate, unsigned int *buf, size_t n)
+{
+  getrandom_state_t *state = (getrandom_state_t *) vstate;
+  size_t k;
+
+  while (n) {
+      if (state->pos == state->n) gr_next(state);
+      k = state->n - state->pos;
+      if (k > n) k = n;
+      memcpy(buf, &state->cur[state->pos], k*sizeof(unsigned int));
+      state->pos += k;
+      buf += k;
+      n -= k;
+  }
+}
+
+/*
+ * Stop and join the reader thread, if it was ever started, and free the
+ * ring.  Called by dh_rng_free().
+ */
+void
+getrandom_prefetch_free (void *vstate)
+{
+  getrandom_state_t *state = (getrandom_state_t *) vstate;
+  gr_ring_t *ring = state->ring;
+
+  if (ring == 0) return;
+  pthread_mutex_lock(&ring->mutex);
+  ring->stop = 1;
+  pthread_cond_broadcast(&ring->cond);
+  pthread_mutex_unlock(&ring->mutex);
+  pthread_join(ring->thread, NULL);
+  pthread_mutex_destroy(&ring->mutex);
+  pthread_cond_destroy(&ring->cond);
+  free(ring->buf);
+  free(ring);
+  state->ring = 0;
+  state->cur = 0;
+  state->pos = state->n = 0;
+}
+
+static double
+getrandom_get_double (void *vstate)
+{
+  return getrandom_get (vstate) / (double) UINT_MAX;
+}
+
+static double
+getrandom_prefetch_get_double (void *vstate)
+{
+  return getrandom_prefetch_get (vstate) / (double) UINT_MAX;
+}
+
+/*
+ * Only empties the buffer, so that the next get asks the kernel.
+ */
+static void
+getrandom_set (void *vstate, unsigned long int s)
+{
+  getrandom_state_t *state = (getrandom_state_t *) vstate;
+
+  state->pos = GR_BUF;
+}
+
+/*
+ * A running ring is left alone (gsl_rng_alloc() hands us a zeroed state,
+ * so ring is 0 until the first get).
+ */
+static void
+getrandom_prefetch_set (void *vstate, unsigned long int s)
+{
+  getrandom_state_t *state = (getrandom_state_t *) vstate;
+
+  if (state->ring == 0) {
+      state->cur = 0;
+      state->pos = state->n = 0;
+  }
+}
+
+static const gsl_rng_type getrandom_type =
+{"getrandom",			/* name */
+ UINT_MAX,			/* RAND_MAX */
+ 0,				/* RAND_MIN */
+ sizeof (getrandom_state_t),
+ &getrandom_set,
+ &getrandom_get,
+ &getrandom_get_double};
+
+static const gsl_rng_type getrandom_prefetch_type =
+{"getrandom_prefetch",		/* name */
+ UINT_MAX,			/* RAND_MAX */
+ 0,				/* RAND_MIN */
+ sizeof (getrandom_state_t),
+ &getrandom_prefetch_set,
+ &getrandom_prefetch_get,
+ &getrandom_prefetch_get_double};
+
+const gsl_rng_type *gsl_rng_getrandom = &getrandom_type;
+const gsl_rng_type *gsl_rng_getrandom_prefetch = &getrandom_prefetch_type;
@@ -0,0 +1,153 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * half64 is a wrapper around another generator that reads it 64 bits at
+ * a time (with dh_rng_fill64()) and hands out only the low or only the
+ * high half of every word, so that the tests, which all eat uints, can
+ * be run on either half of a 64 bit generator or raw64 input by itself.
+ * (Both halves, low first, is what the 64 bit generators already hand
+ * out without any help.)
+ *
+ * Like XOR, the wrapped type is a global, set by dh_rng_half64() when
+ * the generator is chosen; every instance (one per thread under -j) has
+ * its own instance of the wrapped type.  Its substreams are those of the
+ * wrapped type.
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+
+static unsigned long int half64_get (void *vstate);
+static double half64_get_double (void *vstate);
+static void half64_set (void *vstate, unsigned long int s);
+
+#define HALF64_BUF 1024
+
+static const gsl_rng_type *half64_inner = 0;
+static unsigned int half64_half = DH_HALF64_BOTH;
+static char half64_name[64];
+
+typedef struct {
+  gsl_rng *rng;                 /* The wrapped generator */
+  uint64_t w[HALF64_BUF];       /* Its last HALF64_BUF words... */
+  unsigned int pos;             /* ...and the next one to use */
+} half64_state_t;
+
+static inline unsigned int half64_of(uint64_t w)
+{
+ return(half64_half == DH_HALF64_HIGH ? (unsigned int)(w >> 32) : (unsigned int) w);
+}
+
+static unsigned long int half64_get (void *vstate)
+{
+
+ half64_state_t *state = (half64_state_t *) vstate;
+
+ if(state->pos == HALF64_BUF){
+   dh_rng_fill64(state->rng,state->w,HALF64_BUF);
+   state->pos = 0;
+ }
+ return(half64_of(state->w[state->pos++]));
+
+}
+
+/*
+ * half64_get() n times.
+ */
+static void half64_fill (void *vstate, unsigned int *buf, size_t n)
+{
+
+ half64_state_t *state = (half64_state_t *) vstate;
+ size_t i,k;
+
+ while(n){
+   if(state->pos == HALF64_BUF){
+     dh_rng_fill64(state->rng,state->w,HALF64_BUF);
+     state->pos = 0;
+   }
+   k = HALF64_BUF - state->pos;
+   if(k > n) k = n;
+   for(i=0;i<k;i++) buf[i] = half64_of(state->w[state->pos + i]);
+   state->pos += k;
+   buf += k;
+   n -= k;
+ }
+
+}
+
+static double half64_get_double (void *vstate)
+{
+  return (double) half64_get (vstate) / (double) UINT_MAX;
+}
+
+static void half64_set (void *vstate, unsigned long int s)
+{
+
+ half64_state_t *state = (half64_state_t *) vstate;
+
+ if(state->rng == 0) state->rng = gsl_rng_alloc(half64_inner);
+ gsl_rng_set(state->rng,s);
+ state->pos = HALF64_BUF;
+
+}
+
+static void half64_substream (void *vstate, unsigned long int seed, unsigned long int k)
+{
+
+ half64_state_t *state = (half64_state_t *) vstate;
+
+ if(dh_rng_substream(state->rng,seed,k) == 0){
+   gsl_rng_set(state->rng,dh_seed_derive(seed,k));
+ }
+ state->pos = HALF64_BUF;
+
+}
+
+static gsl_rng_type half64_type =
+{"half64",			/* name (see dh_rng_half64()) */
+ UINT_MAX,			/* RAND_MAX */
+ 0,				/* RAND_MIN */
+ sizeof (half64_state_t),
+ &half64_set,
+ &half64_get,
+ &half64_get_double};
+
+/*
+ * The type to test for the half'th halves of type's words, named e.g.
+ * "pcg64 (high 32)".  There is one wrapped type per process.
+ */
+const gsl_rng_type *dh_rng_half64(const gsl_rng_type *type,unsigned int half)
+{
+
+ if(half == DH_HALF64_BOTH) return(type);
+ half64_inner = type;
+ half64_half = half;
+ snprintf(half64_name,sizeof(half64_name),"%s (%s 32)",type->name,
+          half == DH_HALF64_HIGH ? "high" : "low");
+ half64_type.name = half64_name;
+ FILL(&half64_type,half64_fill);
+ SUBSTREAM(&half64_type,half64_substream);
+ return(&half64_type);
+
+}
+
+/*
+ * The wrapped type if type is half64, else type.
+ */
+const gsl_rng_type *dh_rng_half64_inner(const gsl_rng_type *type)
+{
+ return(type == &half64_type ? half64_inner : type);
+}
+
+/*
+ * The wrapped instance if rng is a half64, else 0 (for dh_rng_free()).
+ */
+gsl_rng *dh_rng_half64_wrapped(gsl_rng *rng)
+{
+ return(rng->type == &half64_type ? ((half64_state_t *) rng->state)->rng : 0);
+}
@@ -22,6 +22,11 @@
 
 #include <dieharder/libdieharder.h>
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#define KISS_X86 1
+#include <immintrin.h>
+#endif
+
 static unsigned long int kiss_get (void *vstate);
 static double kiss_get_double (void *vstate);
 static void kiss_set (void *vstate, unsigned long int s);
@@ -57,6 +62,160 @@ static unsigned long int kiss_get (void *vstate)
 
 }
 
+/*
+ * kiss_get() n times, with the state kept in registers.
+ */
+static void kiss_fill_portable (kiss_state_t *state, unsigned int *buf, size_t n)
+{
+
+ unsigned int x = state->x, y = state->y, z = state->z, c = state->c;
+ unsigned long long t;
+ size_t i;
+
+ for(i = 0;i < n;i++){
+   x = 314527869 * x + 1234567;
+   y ^= y << 5;
+   y ^= y >> 7;
+   y ^= y << 22;
+   t = 4294584393ULL * z + c;
+   c = t >> 32;
+   z = t;
+   buf[i] = x + y + z;
+ }
+ state->x = x;
+ state->y = y;
+ state->z = z;
+ state->c = c;
+
+}
+
+#ifdef KISS_X86
+/*
+ * The same stream KISS_LANES*KISS_LANE returns at a time, as KISS_LANES
+ * lanes of an AVX2 register that each make KISS_LANE successive returns.
+ * Lane j starts j*KISS_LANE steps ahead of the state, which all three
+ * components can jump in a handful of operations:
+ *
+ *   x is an LCG, so KISS_LANE steps are x -> KISS_XMUL*x + KISS_XADD;
+ *
+ *   y is an xorshift, linear over GF(2), so KISS_LANE steps are the
+ *   32x32 bit matrix whose columns (the images of 1<<k) are kiss_yjump[];
+ *
+ *   z is a multiply with carry, and with s = c*2^32 + z one step is
+ *   s -> a*s mod (a*2^32 - 1) (a = 4294584393), so KISS_LANE steps are
+ *   s -> KISS_ZMUL*s mod KISS_ZMOD.
+ *
+ * Each lane's returns are collected 8 at a time and stored in order, so
+ * the output is exactly that of kiss_fill_portable().
+ */
+#define KISS_LANES 8
+#define KISS_LANE 256
+#define KISS_XMUL 0x5a4b7401U
+#define KISS_XADD 0x8cf61500U
+#define KISS_ZMUL 0x9381baedce3619f9ULL
+#define KISS_ZMOD 0xfffa2848ffffffffULL
+
+__extension__ typedef unsigned __int128 kiss_u128;    /* Quiet under -pedantic */
+
+static const unsigned int kiss_yjump[32] = {
+ 0x22ad65c6,0xac7ab4a7,0xdfbd8726,0x0f098631,0x10755084,0x90fdcd8c,0x00ff7194,0xbb2e0c9a,
+ 0x2d49efd3,0xa7e0cf5a,0xa03808bb,0x9b43c747,0x0385a109,0xb312ac93,0x12cccc29,0xa93452b3,
+ 0x9a2b1a59,0xadf7a834,0x6440a620,0x8132b1eb,0xd0c3aff6,0xf2fc48e2,0x4d9f59d5,0x31a4b1da,
+ 0xedeafd44,0xabb698d1,0x4fed8b2b,0x27202f23,0xbf8b0cee,0x865633ca,0x5f8dc6df,0x75cd9013
+};
+
+__attribute__((target("avx2")))
+static void kiss_fill_avx2 (kiss_state_t *state, unsigned int *buf, size_t n)
+{
+
+ unsigned int x[KISS_LANES],y[KISS_LANES],z[KISS_LANES],c[KISS_LANES];
+ unsigned int out[8*KISS_LANES] __attribute__((aligned(32)));
+ const __m256i xa = _mm256_set1_epi32(314527869), xc = _mm256_set1_epi32(1234567);
+ const __m256i za = _mm256_set1_epi32((int) 4294584393U), lo = _mm256_set1_epi64x(0xffffffff);
+ __m256i X,Y,Z,C,te,to;
+ uint64_t s;
+ size_t i;
+ int j,k;
+
+ while(n >= KISS_LANES*KISS_LANE){
+
+   x[0] = state->x;
+   y[0] = state->y;
+   z[0] = state->z;
+   c[0] = state->c;
+   for(j = 1;j < KISS_LANES;j++){
+     x[j] = KISS_XMUL * x[j-1] + KISS_XADD;
+     y[j] = 0;
+     for(k = 0;k < 32;k++){
+       if(y[j-1] & (1U << k)) y[j] ^= kiss_yjump[k];
+     }
+     s = ((uint64_t) c[j-1] << 32) | z[j-1];
+     s = (kiss_u128) s * KISS_ZMUL % KISS_ZMOD;
+     z[j] = s;
+     c[j] = s >> 32;
+   }
+   X = _mm256_loadu_si256((const __m256i *) x);
+   Y = _mm256_loadu_si256((const __m256i *) y);
+   Z = _mm256_loadu_si256((const __m256i *) z);
+   C = _mm256_loadu_si256((const __m256i *) c);
+
+   for(i = 0;i < KISS_LANE;i += 8){
+     for(k = 0;k < 8;k++){
+       X = _mm256_add_epi32(_mm256_mullo_epi32(X,xa),xc);
+       Y = _mm256_xor_si256(Y,_mm256_slli_epi32(Y,5));
+       Y = _mm256_xor_si256(Y,_mm256_srli_epi32(Y,7));
+       Y = _mm256_xor_si256(Y,_mm256_slli_epi32(Y,22));
+       /* t = a*z + c in the even and in the odd 32 bit lanes */
+       te = _mm256_add_epi64(_mm256_mul_epu32(Z,za),_mm256_and_si256(C,lo));
+       to = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(Z,32),za),_mm256_srli_epi64(C,32));
+       Z = _mm256_blend_epi32(te,_mm256_slli_epi64(to,32),0xaa);
+       C = _mm256_blend_epi32(_mm256_srli_epi64(te,32),to,0xaa);
+       _mm256_store_si256((__m256i *)(out + 8*k),_mm256_add_epi32(_mm256_add_epi32(X,Y),Z));
+     }
+     for(j = 0;j < KISS_LANES;j++){
+       for(k = 0;k < 8;k++) buf[j*KISS_LANE + i + k] = out[8*k + j];
+     }
+   }
+
+   /* The last lane ends where the next block begins */
+   _mm256_storeu_si256((__m256i *) x,X);
+   _mm256_storeu_si256((__m256i *) y,Y);
+   _mm256_storeu_si256((__m256i *) z,Z);
+   _mm256_storeu_si256((__m256i *) c,C);
+   state->x = x[KISS_LANES-1];
+   state->y = y[KISS_LANES-1];
+   state->z = z[KISS_LANES-1];
+   state->c = c[KISS_LANES-1];
+   buf += KISS_LANES*KISS_LANE;
+   n -= KISS_LANES*KISS_LANE;
+
+ }
+ kiss_fill_portable(state,buf,n);
+
+}
+#endif
+
+/*
+ * Pick the fastest kernel this CPU can run, once.
+ */
+typedef void (*kiss_fill_t)(kiss_state_t *state, unsigned int *buf, size_t n);
+static kiss_fill_t kiss_fill_kernel = 0;
+
+void kiss_fill (void *vstate, unsigned int *buf, size_t n)
+{
+
+ if(kiss_fill_kernel == 0){
+   kiss_fill_t f = kiss_fill_portable;
+#ifdef KISS_X86
+   __builtin_cpu_init();
+   if(__builtin_cpu_supports("avx2")) f = kiss_fill_avx2;
+#endif
+   kiss_fill_kernel = f;
+ }
+ kiss_fill_kernel((kiss_state_t *) vstate,buf,n);
+
+}
+
 static double kiss_get_double (void *vstate)
 {
   return (double) kiss_get (vstate) / (double) UINT_MAX;
@@ -0,0 +1,232 @@
+/*
+ *  rng_pcg64.c
+ *
+ *  PCG64 (pcg_setseq_128_xsl_rr_64, as in numpy), from:
+ *
+ * M. E. O'Neill, "PCG: A Family of Simple Fast Space-Efficient
+ * Statistically Good Algorithms for Random Number Generation",
+ * HMC-CS-2014-0905 (2014), and the Apache licensed pcg-c at
+ * http://www.pcg-random.org/.
+ *
+ * The state is a 128 bit LCG (period 2^128), stepped and then output
+ * through the XSL RR permutation, with PCG's default increment.  An LCG
+ * can jump any distance in log2 steps (pcg64_advance()), and the k'th
+ * substream of a seed starts k*2^64 steps past it, so there are 2^64
+ * substreams of 2^64 64 bit returns each.
+ *
+ * Every 64 bit return is handed out as two uints, low half first, and
+ * the seed is expanded to 128 bits with splitmix64_next().  The 128 bit
+ * arithmetic uses the compiler's __int128 where there is one.
+ */
+
+#include <dieharder/libdieharder.h>
+
+static unsigned long int pcg64_get (void *vstate);
+static double pcg64_get_double (void *vstate);
+static void pcg64_set (void *vstate, unsigned long int s);
+
+typedef struct {
+ uint64_t hi;
+ uint64_t lo;
+} pcg128_t;
+
+typedef struct {
+ pcg128_t state;
+ pcg128_t inc;          /* Must be odd */
+ uint32_t hi;           /* The unused high half of the last return */
+ int have_hi;
+} pcg64_state_t;
+
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 pcg_u128;   /* Quiet under -pedantic */
+#endif
+
+static const pcg128_t PCG64_MULT = { 0x2360ed051fc65da4ULL, 0x4385df649fccf645ULL };
+static const pcg128_t PCG64_INC = { 0x5851f42d4c957f2dULL, 0x14057b7ef767814fULL };
+
+static inline pcg128_t pcg128_add(pcg128_t a, pcg128_t b)
+{
+
+ pcg128_t r;
+
+ r.lo = a.lo + b.lo;
+ r.hi = a.hi + b.hi + (r.lo < a.lo);
+ return r;
+
+}
+
+static inline pcg128_t pcg128_mul(pcg128_t a, pcg128_t b)
+{
+
+ pcg128_t r;
+#ifdef __SIZEOF_INT128__
+ pcg_u128 p = (pcg_u128) a.lo * b.lo;
+
+ r.lo = (uint64_t) p;
+ r.hi = (uint64_t)(p >> 64) + a.hi * b.lo + a.lo * b.hi;
+#else
+ uint64_t a0 = a.lo & 0xffffffff, a1 = a.lo >> 32;
+ uint64_t b0 = b.lo & 0xffffffff, b1 = b.lo >> 32;
+ uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+ uint64_t mid = (p00 >> 32) + (p01 & 0xffffffff) + (p10 & 0xffffffff);
+
+ r.lo = (mid << 32) | (p00 & 0xffffffff);
+ r.hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32) + a.hi * b.lo + a.lo * b.hi;
+#endif
+ return r;
+
+}
+
+static inline uint64_t pcg64_next(pcg128_t *state, pcg128_t inc)
+{
+
+ uint64_t x;
+ unsigned int rot;
+
+ *state = pcg128_add(pcg128_mul(*state,PCG64_MULT),inc);
+ x = state->hi ^ state->lo;
+ rot = state->hi >> 58;
+ return (x >> rot) | (x << ((64 - rot) & 63));
+
+}
+
+static unsigned long int pcg64_get (void *vstate)
+{
+
+ pcg64_state_t *state = vstate;
+ uint64_t z;
+
+ if(state->have_hi){
+   state->have_hi = 0;
+   return state->hi;
+ }
+ z = pcg64_next(&state->state,state->inc);
+ state->hi = z >> 32;
+ state->have_hi = 1;
+ return (uint32_t) z;
+
+}
+
+/*
+ * pcg64_get() n times, with the state kept in registers.
+ */
+void pcg64_fill (void *vstate, unsigned int *buf, size_t n)
+{
+
+ pcg64_state_t *state = vstate;
+ pcg128_t s = state->state, inc = state->inc;
+ uint64_t z;
+
+ if(n && state->have_hi){
+   *buf++ = state->hi;
+   state->have_hi = 0;
+   n--;
+ }
+ for(;n >= 2;n -= 2){
+   z = pcg64_next(&s,inc);
+   *buf++ = (uint32_t) z;
+   *buf++ = z >> 32;
+ }
+ if(n){
+   z = pcg64_next(&s,inc);
+   *buf = (uint32_t) z;
+   state->hi = z >> 32;
+   state->have_hi = 1;
+ }
+ state->state = s;
+
+}
+
+/*
+ * The next n whole 64 bit returns (see dh_rng_fill64()).  A pending high
+ * half is dropped.
+ */
+void pcg64_fill64 (void *vstate, uint64_t *buf, size_t n)
+{
+
+ pcg64_state_t *state = vstate;
+ pcg128_t s = state->state, inc = state->inc;
+
+ while(n--) *buf++ = pcg64_next(&s,inc);
+ state->state = s;
+ state->have_hi = 0;
+
+}
+
+/*
+ * Advance the state by delta_hi*2^64 + delta_lo steps, by Brown's
+ * algorithm ("Random Number Generation with Arbitrary Strides", 1994):
+ * square the step's multiplier and increment for every bit of delta.
+ * A pending high half is dropped.
+ */
+void pcg64_advance (void *vstate, uint64_t delta_hi, uint64_t delta_lo)
+{
+
+ pcg64_state_t *state = vstate;
+ pcg128_t cur_mult = PCG64_MULT, cur_plus = state->inc;
+ pcg128_t acc_mult = { 0, 1 }, acc_plus = { 0, 0 };
+ pcg128_t one = { 0, 1 };
+
+ while(delta_hi | delta_lo){
+   if(delta_lo & 1){
+     acc_mult = pcg128_mul(acc_mult,cur_mult);
+     acc_plus = pcg128_add(pcg128_mul(acc_plus,cur_mult),cur_plus);
+   }
+   cur_plus = pcg128_mul(pcg128_add(cur_mult,one),cur_plus);
+   cur_mult = pcg128_mul(cur_mult,cur_mult);
+   delta_lo = (delta_lo >> 1) | (delta_hi << 63);
+   delta_hi >>= 1;
+ }
+ state->state = pcg128_add(pcg128_mul(acc_mult,state->state),acc_plus);
+ state->have_hi = 0;
+
+}
+
+static double pcg64_get_double (void *vstate)
+{
+  return (double) pcg64_get (vstate) / (double) UINT_MAX;
+}
+
+/*
+ * pcg-c's srandom:  step from zero, add the initial state, step again.
+ */
+static void pcg64_set (void *vstate, unsigned long int s)
+{
+
+ pcg64_state_t *state = vstate;
+ uint64_t x = s;
+ pcg128_t init;
+
+ init.hi = splitmix64_next(&x);
+ init.lo = splitmix64_next(&x);
+ state->inc = PCG64_INC;
+ state->state.hi = 0;
+ state->state.lo = 0;
+ pcg64_next(&state->state,state->inc);
+ state->state = pcg128_add(state->state,init);
+ pcg64_next(&state->state,state->inc);
+ state->have_hi = 0;
+
+}
+
+/*
+ * Seed with seed and advance k*2^64 steps (see above).
+ */
+void pcg64_substream (void *vstate, unsigned long int seed, unsigned long int k)
+{
+
+ pcg64_set(vstate,seed);
+ pcg64_advance(vstate,k,0);
+
+}
+
+static const gsl_rng_type pcg64_type =
+{"pcg64",			/* name */
+ UINT_MAX,			/* RAND_MAX */
+ 0,				/* RAND_MIN */
+ sizeof (pcg64_state_t),
+ &pcg64_set,
+ &pcg64_get,
+ &pcg64_get_double};
+
+const gsl_rng_type *gsl_rng_pcg64 = &pcg64_type;
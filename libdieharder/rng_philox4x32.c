@@ -0,0 +1,146 @@
+/*
+ *  rng_philox4x32.c
+ *
+ *  Philox4x32-10, the counter based generator from:
+ *
+ * J. K. Salmon, M. A. Moraes, R. O. Dror and D. E. Shaw, "Parallel
+ * Random Numbers: As Easy as 1, 2, 3", SC11 (2011),
+ *
+ * after Random123 (http://www.deshawresearch.com/resources_random123.html).
+ * Every 128 bit counter is encrypted, with a 64 bit key, into four
+ * uints by ten rounds of multiplies and xors.  The key is expanded from
+ * the seed with splitmix64_next(); the low 64 bits of the counter count
+ * the blocks of a stream and the high 64 bits are the substream number,
+ * so there are 2^64 substreams of 2^66 uints each, and moving to one
+ * costs nothing at all.
+ */
+
+#include <dieharder/libdieharder.h>
+
+static unsigned long int philox4x32_get (void *vstate);
+static double philox4x32_get_double (void *vstate);
+static void philox4x32_set (void *vstate, unsigned long int s);
+
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+
+typedef struct {
+ uint32_t key[2];
+ uint64_t block;        /* Counter words 0-1: the next block */
+ uint64_t stream;       /* Counter words 2-3: the substream */
+ uint32_t out[4];       /* The last block... */
+ unsigned int pos;      /* ...and its next unused uint */
+} philox4x32_state_t;
+
+/*
+ * Encrypt counter (block,stream) under key into out[0..3].
+ */
+static inline void philox4x32_block(const uint32_t *key, uint64_t block, uint64_t stream, uint32_t *out)
+{
+
+ uint32_t c0 = (uint32_t) block, c1 = block >> 32;
+ uint32_t c2 = (uint32_t) stream, c3 = stream >> 32;
+ uint32_t k0 = key[0], k1 = key[1];
+ uint64_t p0,p1;
+ int r;
+
+ for(r = 0;r < 10;r++){
+   p0 = (uint64_t) PHILOX_M0 * c0;
+   p1 = (uint64_t) PHILOX_M1 * c2;
+   c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+   c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+   c1 = (uint32_t) p1;
+   c3 = (uint32_t) p0;
+   k0 += PHILOX_W0;
+   k1 += PHILOX_W1;
+ }
+ out[0] = c0;
+ out[1] = c1;
+ out[2] = c2;
+ out[3] = c3;
+
+}
+
+static unsigned long int philox4x32_get (void *vstate)
+{
+
+ philox4x32_state_t *state = vstate;
+
+ if(state->pos == 4){
+   philox4x32_block(state->key,state->block++,state->stream,state->out);
+   state->pos = 0;
+ }
+ return state->out[state->pos++];
+
+}
+
+/*
+ * philox4x32_get() n times.  Whole blocks go straight into buf.
+ */
+void philox4x32_fill (void *vstate, unsigned int *buf, size_t n)
+{
+
+ philox4x32_state_t *state = vstate;
+
+ while(n && state->pos < 4){
+   *buf++ = state->out[state->pos++];
+   n--;
+ }
+ for(;n >= 4;n -= 4){
+   philox4x32_block(state->key,state->block++,state->stream,buf);
+   buf += 4;
+ }
+ if(n){
+   philox4x32_block(state->key,state->block++,state->stream,state->out);
+   for(state->pos = 0;state->pos < n;state->pos++){
+     buf[state->pos] = state->out[state->pos];
+   }
+ }
+
+}
+
+static double philox4x32_get_double (void *vstate)
+{
+  return (double) philox4x32_get (vstate) / (double) UINT_MAX;
+}
+
+static void philox4x32_set (void *vstate, unsigned long int s)
+{
+
+ philox4x32_state_t *state = vstate;
+ uint64_t x = s,k;
+
+ k = splitmix64_next(&x);
+ state->key[0] = (uint32_t) k;
+ state->key[1] = k >> 32;
+ state->block = 0;
+ state->stream = 0;
+ state->pos = 4;
+
+}
+
+/*
+ * Seed with seed and select substream k (see above).
+ */
+void philox4x32_substream (void *vstate, unsigned long int seed, unsigned long int k)
+{
+
+ philox4x32_state_t *state = vstate;
+
+ philox4x32_set(vstate,seed);
+ state->stream = k;
+
+}
+
+static const gsl_rng_type philox4x32_type =
+{"philox4x32",			/* name */
+ UINT_MAX,			/* RAND_MAX */
+ 0,				/* RAND_MIN */
+ sizeof (philox4x32_state_t),
+ &philox4x32_set,
+ &philox4x32_get,
+ &philox4x32_get_double};
+
+const gsl_rng_type *gsl_rng_philox4x32 = &philox4x32_type;
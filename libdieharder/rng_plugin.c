@@ -0,0 +1,281 @@
+/*
+ *========================================================================
+ * See copyright in copyright.h and the accompanying file COPYING
+ *========================================================================
+ */
+
+/*
+ *========================================================================
+ * Generators loaded at run time from shared objects (see dh_plugin.h
+ * for the ABI).  dh_rng_plugin_load() dlopen()s a plugin, makes it a
+ * gsl_rng_type of its own in the first free slot from 700 up in
+ * dh_rng_types[], and registers its fill routines (and, if it has a
+ * jump, its substream routine), so it runs like any built in generator.
+ *
+ * gsl_rng_type set routines are not told which type they belong to, so
+ * every plugin slot gets its own little set routine (PLUGIN_SET below)
+ * that passes its slot on.  get, get_double and fill find the plugin
+ * through the state.  A gsl_rng has no destructor either, so plugin
+ * instances should be freed with dh_rng_free(), which calls the
+ * plugin's destroy().
+ *========================================================================
+ */
+
+#include <dieharder/libdieharder.h>
+#include <dieharder/dh_plugin.h>
+#include <dlfcn.h>
+
+#define DH_MAXPLUGINS 8
+#define PLUGIN_BUF 1024         /* uints per refill of get() */
+
+typedef struct {
+  char *spec;                   /* path[:args], as loaded */
+  char *args;
+  void *dl;
+  const dh_plugin *plugin;
+  gsl_rng_type type;
+  int gennum;                   /* Where it is in dh_rng_types[] */
+} plugin_slot_t;
+
+static plugin_slot_t plugin_slots[DH_MAXPLUGINS];
+static unsigned int dh_num_plugins = 0;
+
+/*
+ * strdup() is not declared under -std=c99, so keep our own.
+ */
+static char *plugin_strdup(const char *s)
+{
+
+ size_t n = strlen(s) + 1;
+ char *d = (char *) malloc(n);
+
+ if(d) memcpy(d,s,n);
+ return(d);
+
+}
+
+typedef struct {
+  plugin_slot_t *slot;
+  void *g;                      /* The plugin's instance */
+  unsigned int buf[PLUGIN_BUF];
+  unsigned int pos;
+} plugin_state_t;
+
+static unsigned long int plugin_get (void *vstate);
+static double plugin_get_double (void *vstate);
+
+/*
+ * Create the instance on the first call (from gsl_rng_alloc()), and
+ * seed it on every call.
+ */
+static void plugin_set_slot(void *vstate,unsigned long int s,plugin_slot_t *slot)
+{
+
+ plugin_state_t *state = (plugin_state_t *) vstate;
+
+ if(state->g == 0){
+   state->slot = slot;
+   state->g = slot->plugin->create(slot->args);
+   if(state->g == 0){
+     fprintf(stderr,"Error: plugin %s cannot create an instance with args \"%s\".\n",slot->plugin->name,slot->args);
+     exit(1);
+   }
+ }
+ slot->plugin->seed(state->g,(uint64_t) s);
+ state->pos = PLUGIN_BUF;
+
+}
+
+#define PLUGIN_SET(k) \
+static void plugin_set_##k(void *vstate,unsigned long int s) \
+{ plugin_set_slot(vstate,s,&plugin_slots[k]); }
+
+PLUGIN_SET(0)
+PLUGIN_SET(1)
+PLUGIN_SET(2)
+PLUGIN_SET(3)
+PLUGIN_SET(4)
+PLUGIN_SET(5)
+PLUGIN_SET(6)
+PLUGIN_SET(7)
+
+static void (*plugin_sets[DH_MAXPLUGINS])(void *,unsigned long int) = {
+ plugin_set_0,plugin_set_1,plugin_set_2,plugin_set_3,
+ plugin_set_4,plugin_set_5,plugin_set_6,plugin_set_7
+};
+
+static unsigned long int plugin_get (void *vstate)
+{
+
+ plugin_state_t *state = (plugin_state_t *) vstate;
+
+ if(state->pos == PLUGIN_BUF){
+   state->slot->plugin->fill_u32(state->g,(uint32_t *) state->buf,PLUGIN_BUF);
+   state->pos = 0;
+ }
+ return(state->buf[state->pos++]);
+
+}
+
+/*
+ * plugin_get() n times:  what is left of the buffer, and then the rest
+ * straight from the plugin into buf.
+ */
+static void plugin_fill (void *vstate,unsigned int *buf,size_t n)
+{
+
+ plugin_state_t *state = (plugin_state_t *) vstate;
+ size_t k;
+
+ k = PLUGIN_BUF - state->pos;
+ if(k > n) k = n;
+ memcpy(buf,&state->buf[state->pos],k*sizeof(unsigned int));
+ state->pos += k;
+ if(n > k) state->slot->plugin->fill_u32(state->g,(uint32_t *)(buf + k),n - k);
+
+}
+
+static double plugin_get_double (void *vstate)
+{
+  return (double) plugin_get (vstate) / (double) UINT_MAX;
+}
+
+/*
+ * The next n 64 bit outputs, for plugins that have them.  The uints left
+ * over from the last plugin_get() refill are dropped.
+ */
+static void plugin_fill64 (void *vstate,uint64_t *buf,size_t n)
+{
+
+ plugin_state_t *state = (plugin_state_t *) vstate;
+
+ state->slot->plugin->fill_u64(state->g,buf,n);
+ state->pos = PLUGIN_BUF;
+
+}
+
+static void plugin_substream (void *vstate,unsigned long int seed,unsigned long int k)
+{
+
+ plugin_state_t *state = (plugin_state_t *) vstate;
+
+ plugin_set_slot(vstate,seed,state->slot);
+ state->slot->plugin->jump(state->g,(uint64_t) k);
+
+}
+
+/*
+ * Load the plugin spec = path[:args] (the args are everything after the
+ * first ':' that follows the last '/') and return its generator number,
+ * or -1 (after saying why on stderr) if it cannot be loaded.  Loading the
+ * same spec twice returns the same generator.
+ */
+int dh_rng_plugin_load(const char *spec)
+{
+
+ plugin_slot_t *slot;
+ dh_plugin_entry_t entry;
+ const dh_plugin *plugin;
+ char *path,*colon,*slash;
+ void *dl;
+ int i;
+
+ for(i=0;i<(int) dh_num_plugins;i++){
+   if(strcmp(plugin_slots[i].spec,spec) == 0) return(plugin_slots[i].gennum);
+ }
+ if(dh_num_plugins == DH_MAXPLUGINS){
+   fprintf(stderr,"Error: cannot load more than %u plugins.\n",DH_MAXPLUGINS);
+   return(-1);
+ }
+
+ path = plugin_strdup(spec);
+ slash = strrchr(path,'/');
+ colon = strchr(slash ? slash : path,':');
+ if(colon) *colon = 0;
+
+ dl = dlopen(path,RTLD_NOW | RTLD_LOCAL);
+ if(dl == 0){
+   fprintf(stderr,"Error: cannot load plugin %s: %s\n",path,dlerror());
+   free(path);
+   return(-1);
+ }
+ *(void **)(&entry) = dlsym(dl,DH_PLUGIN_ENTRY);
+ plugin = entry ? entry() : 0;
+ if(plugin == 0 || plugin->abi < 1 || plugin->abi > DH_PLUGIN_ABI ||
+    plugin->create == 0 || plugin->seed == 0 || plugin->fill_u32 == 0 ||
+    plugin->destroy == 0){
+   fprintf(stderr,"Error: %s is not a dieharder plugin (ABI %d) or is missing a required routine.\n",path,DH_PLUGIN_ABI);
+   dlclose(dl);
+   free(path);
+   return(-1);
+ }
+
+ /*
+  * The first free slot in the reserved range.
+  */
+ for(i=700;i<MAXRNGS;i++){
+   if(dh_rng_types[i] == 0) break;
+ }
+ if(i == MAXRNGS){
+   fprintf(stderr,"Error: no room left in dh_rng_types for plugin %s.\n",path);
+   dlclose(dl);
+   free(path);
+   return(-1);
+ }
+
+ slot = &plugin_slots[dh_num_plugins];
+ slot->spec = plugin_strdup(spec);
+ slot->args = colon ? colon + 1 : path + strlen(path);
+ slot->dl = dl;
+ slot->plugin = plugin;
+ slot->gennum = i;
+ slot->type.name = (plugin->name && plugin->name[0]) ? plugin->name : path;
+ slot->type.max = UINT_MAX;
+ slot->type.min = 0;
+ slot->type.size = sizeof(plugin_state_t);
+ slot->type.set = plugin_sets[dh_num_plugins];
+ slot->type.get = plugin_get;
+ slot->type.get_double = plugin_get_double;
+ dh_num_plugins++;
+
+ dh_rng_types[i] = &slot->type;
+ FILL(&slot->type,plugin_fill);
+ if(plugin->fill_u64) FILL64(&slot->type,plugin_fill64);
+ if(plugin->jump) SUBSTREAM(&slot->type,plugin_substream);
+ dh_num_reserved_rngs++;
+ dh_num_rngs++;
+
+ MYDEBUG(D_TYPES){
+   printf("# dh_rng_plugin_load(): %s from %s is generator %d.\n",slot->type.name,path,i);
+ }
+ return(i);
+
+}
+
+/*
+ * gsl_rng_free(), after destroying the instance of a plugin generator
+ * (or the plugin instance wrapped by half64), stopping the reader
+ * thread of a getrandom_prefetch instance, or freeing the components
+ * (and prefetch threads) of an XOR instance.
+ */
+void dh_rng_free(gsl_rng *rng)
+{
+
+ unsigned int i;
+ plugin_state_t *state;
+
+ if(rng == 0) return;
+ dh_rng_free(dh_rng_half64_wrapped(rng));
+ if(rng->type == gsl_rng_getrandom_prefetch) getrandom_prefetch_free(rng->state);
+ if(rng->type == gsl_rng_XOR) XOR_free(rng->state);
+ for(i=0;i<dh_num_plugins;i++){
+   if(rng->type == &plugin_slots[i].type){
+     state = (plugin_state_t *) rng->state;
+     if(state->g) plugin_slots[i].plugin->destroy(state->g);
+     state->g = 0;
+     break;
+   }
+ }
+ gsl_rng_free(rng);
+
+}
@@ -0,0 +1,231 @@
+/*
+ * shm_input
+ *
+ * See copyright in copyright.h and the accompanying file COPYING
+ *
+ */
+
+#include <dieharder/libdieharder.h>
+#include <dieharder/dh_shm.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#else
+#include <sched.h>
+#endif
+
+/*
+ * This reads raw words from a local producer process through the shared
+ * memory ring described in dh_shm.h, named by -f (e.g. -f /myrng).
+ * Unlike a pipe nothing goes through the kernel:  get and fill read the
+ * words straight out of the ring, and we only touch the shared head and
+ * tail (and sleep on a futex if the producer is behind) once per block.
+ * The segment is waited for if the producer has not made it yet.
+ *
+ * As with stdin there is one stream per process, so the ring is a
+ * global (shm) rather than part of the state, and seeding does nothing.
+ * The words are taken as uints in host byte order; with a producer of 64
+ * bit words that is low half first on a little endian host, and -H can
+ * pick out either half (shm_input has a 64 bit fill).
+ */
+
+static unsigned long int shm_input_get (void *vstate);
+static double shm_input_get_double (void *vstate);
+static void shm_input_set (void *vstate, unsigned long int s);
+
+static struct {
+  dh_shm_header *h;
+  unsigned char *data;
+  uint64_t mask;                /* size - 1 */
+  uint64_t pos;                 /* Bytes consumed (our tail)... */
+  uint64_t end;                 /* ...and how far we may read before we look again */
+  uint64_t block;               /* Bytes between releases of the tail */
+} shm;
+
+static void shm_input_wait(uint32_t *seq,uint32_t val)
+{
+#if defined(__linux__) && defined(SYS_futex)
+ syscall(SYS_futex,seq,FUTEX_WAIT,val,NULL,NULL,0);
+#else
+ sched_yield();
+#endif
+}
+
+static void shm_input_wake(uint32_t *seq)
+{
+#if defined(__linux__) && defined(SYS_futex)
+ syscall(SYS_futex,seq,FUTEX_WAKE,1,NULL,NULL,0);
+#endif
+}
+
+/*
+ * At exit, tell a producer waiting for room not to bother.
+ */
+static void shm_input_detach(void)
+{
+
+ __atomic_store_n(&shm.h->detached,1,__ATOMIC_RELEASE);
+ __atomic_add_fetch(&shm.h->space_seq,1,__ATOMIC_SEQ_CST);
+ shm_input_wake(&shm.h->space_seq);
+
+}
+
+/*
+ * Map the ring named filename, waiting (politely) for the producer to
+ * make it.
+ */
+static void shm_input_attach(void)
+{
+
+ struct stat sbuf;
+ dh_shm_header *h;
+ void *m;
+ int fd,said = 0;
+
+ if(filename[0] == 0){
+   fprintf(stderr,"Error: shm_input needs the name of the ring (-f /name).  Exiting.\n");
+   exit(0);
+ }
+ while(1){
+   fd = shm_open(filename,O_RDWR,0);
+   if(fd >= 0){
+     if(fstat(fd,&sbuf) == 0 && sbuf.st_size >= DH_SHM_HEADER + 4096) break;
+     close(fd);
+   } else if(errno != ENOENT){
+     fprintf(stderr,"Error: cannot open %s: %s.  Exiting.\n",filename,strerror(errno));
+     exit(0);
+   }
+   if(!said){
+     fprintf(stderr,"# shm_input(): waiting for a producer to create %s\n",filename);
+     said = 1;
+   }
+   usleep(10000);
+ }
+
+ m = mmap(NULL,sbuf.st_size,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+ close(fd);
+ if(m == MAP_FAILED){
+   fprintf(stderr,"Error: cannot map %s: %s.  Exiting.\n",filename,strerror(errno));
+   exit(0);
+ }
+ h = (dh_shm_header *) m;
+ while(__atomic_load_n(&h->magic,__ATOMIC_ACQUIRE) != DH_SHM_MAGIC) usleep(1000);
+ if(h->version != DH_SHM_VERSION || (h->size & (h->size - 1)) != 0 ||
+    h->header_size + h->size > (uint64_t) sbuf.st_size){
+   fprintf(stderr,"Error: %s is not a version %d dieharder ring.  Exiting.\n",filename,DH_SHM_VERSION);
+   exit(0);
+ }
+
+ shm.h = h;
+ shm.data = (unsigned char *) m + h->header_size;
+ shm.mask = h->size - 1;
+ shm.pos = shm.end = __atomic_load_n(&h->tail,__ATOMIC_ACQUIRE);
+ shm.block = h->size/4;
+ atexit(shm_input_detach);
+ if(verbose == D_ALL){
+   fprintf(stdout,"# shm_input(): attached to %s, %lu byte ring of %u byte words\n",
+           filename,(unsigned long) h->size,h->word_size);
+ }
+
+}
+
+/*
+ * Give back what we have read, then wait until there is at least a
+ * word to read and set end to as much as we may read (at most a block,
+ * so that the producer always has room coming).
+ */
+static void shm_input_next(void)
+{
+
+ dh_shm_header *h;
+ uint64_t head;
+ uint32_t seq;
+
+ if(shm.h == 0) shm_input_attach();
+ h = shm.h;
+
+ __atomic_store_n(&h->tail,shm.pos,__ATOMIC_RELEASE);
+ __atomic_add_fetch(&h->space_seq,1,__ATOMIC_SEQ_CST);
+ if(__atomic_load_n(&h->producer_waiting,__ATOMIC_SEQ_CST)) shm_input_wake(&h->space_seq);
+
+ while(1){
+   seq = __atomic_load_n(&h->data_seq,__ATOMIC_ACQUIRE);
+   head = __atomic_load_n(&h->head,__ATOMIC_ACQUIRE);
+   if(head - shm.pos >= sizeof(unsigned int)) break;
+   if(__atomic_load_n(&h->eof,__ATOMIC_ACQUIRE)){
+     fprintf(stderr,"# shm_input(): Error: EOF\n");
+     exit(0);
+   }
+   __atomic_store_n(&h->consumer_waiting,1,__ATOMIC_SEQ_CST);
+   shm_input_wait(&h->data_seq,seq);
+   __atomic_store_n(&h->consumer_waiting,0,__ATOMIC_RELAXED);
+ }
+ head -= (head - shm.pos) % sizeof(unsigned int);
+ shm.end = head - shm.pos > shm.block ? shm.pos + shm.block : head;
+
+}
+
+static unsigned long int
+shm_input_get (void *vstate)
+{
+  unsigned int w;
+
+  if (shm.pos == shm.end) shm_input_next();
+  w = *(unsigned int *) (shm.data + (shm.pos & shm.mask));
+  shm.pos += sizeof(unsigned int);
+  return w;
+}
+
+/*
+ * Bulk version of shm_input_get(), a contiguous piece of the ring at a
+ * time.
+ */
+void
+shm_input_fill (void *vstate, unsigned int *buf, size_t n)
+{
+  uint64_t k,off;
+
+  while (n) {
+      if (shm.pos == shm.end) shm_input_next();
+      off = shm.pos & shm.mask;
+      k = (shm.end - shm.pos)/sizeof(unsigned int);
+      if (k > (shm.mask + 1 - off)/sizeof(unsigned int)) k = (shm.mask + 1 - off)/sizeof(unsigned int);
+      if (k > n) k = n;
+      memcpy(buf,shm.data + off,k*sizeof(unsigned int));
+      shm.pos += k*sizeof(unsigned int);
+      buf += k;
+      n -= k;
+  }
+}
+
+void
+shm_input_fill64 (void *vstate, uint64_t *buf, size_t n)
+{
+  shm_input_fill(vstate,(unsigned int *) buf,2*n);
+}
+
+static double
+shm_input_get_double (void *vstate)
+{
+  return shm_input_get(vstate) / (double)UINT_MAX;
+}
+
+static void
+shm_input_set (void *vstate, unsigned long int s)
+{
+    /* empty */
+}
+
+static const gsl_rng_type shm_input_type =
+{"shm_input",                   /* name */
+ UINT_MAX,                      /* RAND_MAX */
+ 0,                             /* RAND_MIN */
+ 0,
+ shm_input_set,
+ shm_input_get,
+ shm_input_get_double};
+
+const gsl_rng_type *gsl_rng_shm_input = &shm_input_type;
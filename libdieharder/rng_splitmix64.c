@@ -0,0 +1,146 @@
+/*
+ *  rng_splitmix64.c
+ *
+ *  SplitMix64, the generator of Java's SplittableRandom, from:
+ *
+ * G. L. Steele, D. Lea and C. H. Flood, "Fast Splittable Pseudorandom
+ * Number Generators", OOPSLA 2014,
+ *
+ * as written in C by Sebastiano Vigna (http://prng.di.unimi.it/), who
+ * placed it in the public domain.  The state is a 64 bit Weyl sequence
+ * (x += golden ratio) and the output a strong mix of it, so the period
+ * is 2^64 and jumping is trivial:  the k'th substream of a seed is the
+ * stream of the seed started 2^40*k steps in, so there are 2^24
+ * substreams of 2^40 64 bit returns each.
+ *
+ * Every 64 bit return is handed out as two uints, low half first.
+ * splitmix64_next() is also what the other 64 bit generators use to
+ * expand a seed into their state, as Vigna recommends.
+ */
+
+#include <dieharder/libdieharder.h>
+
+static unsigned long int splitmix64_get (void *vstate);
+static double splitmix64_get_double (void *vstate);
+static void splitmix64_set (void *vstate, unsigned long int s);
+
+#define SPLITMIX64_GAMMA 0x9e3779b97f4a7c15ULL
+
+typedef struct {
+ uint64_t x;
+ uint32_t hi;           /* The unused high half of the last return */
+ int have_hi;
+} splitmix64_state_t;
+
+uint64_t splitmix64_next(uint64_t *x)
+{
+
+ uint64_t z = (*x += SPLITMIX64_GAMMA);
+
+ z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+ z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+ return z ^ (z >> 31);
+
+}
+
+static unsigned long int splitmix64_get (void *vstate)
+{
+
+ splitmix64_state_t *state = vstate;
+ uint64_t z;
+
+ if(state->have_hi){
+   state->have_hi = 0;
+   return state->hi;
+ }
+ z = splitmix64_next(&state->x);
+ state->hi = z >> 32;
+ state->have_hi = 1;
+ return (uint32_t) z;
+
+}
+
+/*
+ * splitmix64_get() n times.
+ */
+void splitmix64_fill (void *vstate, unsigned int *buf, size_t n)
+{
+
+ splitmix64_state_t *state = vstate;
+ uint64_t x,z;
+
+ if(n && state->have_hi){
+   *buf++ = state->hi;
+   state->have_hi = 0;
+   n--;
+ }
+ x = state->x;
+ for(;n >= 2;n -= 2){
+   z = splitmix64_next(&x);
+   *buf++ = (uint32_t) z;
+   *buf++ = z >> 32;
+ }
+ if(n){
+   z = splitmix64_next(&x);
+   *buf = (uint32_t) z;
+   state->hi = z >> 32;
+   state->have_hi = 1;
+ }
+ state->x = x;
+
+}
+
+/*
+ * The next n whole 64 bit returns (see dh_rng_fill64()).  A pending high
+ * half is dropped.
+ */
+void splitmix64_fill64 (void *vstate, uint64_t *buf, size_t n)
+{
+
+ splitmix64_state_t *state = vstate;
+ uint64_t x = state->x;
+
+ while(n--) *buf++ = splitmix64_next(&x);
+ state->x = x;
+ state->have_hi = 0;
+
+}
+
+static double splitmix64_get_double (void *vstate)
+{
+  return (double) splitmix64_get (vstate) / (double) UINT_MAX;
+}
+
+static void splitmix64_set (void *vstate, unsigned long int s)
+{
+
+ splitmix64_state_t *state = vstate;
+
+ state->x = s;
+ state->have_hi = 0;
+
+}
+
+/*
+ * Seed with seed and skip to the k'th substream (see above).
+ */
+void splitmix64_substream (void *vstate, unsigned long int seed, unsigned long int k)
+{
+
+ splitmix64_state_t *state = vstate;
+
+ splitmix64_set(vstate,seed);
+ state->x += SPLITMIX64_GAMMA * ((uint64_t) k << 40);
+
+}
+
+static const gsl_rng_type splitmix64_type =
+{"splitmix64",			/* name */
+ UINT_MAX,			/* RAND_MAX */
+ 0,				/* RAND_MIN */
+ sizeof (splitmix64_state_t),
+ &splitmix64_set,
+ &splitmix64_get,
+ &splitmix64_get_double};
+
+const gsl_rng_type *gsl_rng_splitmix64 = &splitmix64_type;
@@ -1,30 +1,212 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include <dieharder/libdieharder.h>
 
 /*
  * This is a wrapping of stdin.
+ *
+ * stdin is read by a prefetch thread, in large read()s, into a ring of
+ * SIR_NBLOCKS blocks of SIR_BLOCK uints.  The generator hands out the
+ * uints of one block after the other, and only takes the ring's lock
+ * to trade in a used block for a full one, so a get costs no syscall
+ * and no lock (where fread() locked stdin for every uint).  Both sides
+ * keep track of how long they wait on the other:  time the tests spend
+ * waiting for a full block means the source is too slow, time the
+ * reader spends waiting for an empty one means the tests are.  See
+ * stdin_input_get_stalls().
+ *
+ * There is only one stdin, so there is only one ring, shared by all
+ * instances of the generator, and the thread is started on the first
+ * get.
  */
 
 static unsigned long int stdin_input_raw_get (void *vstate);
 static double stdin_input_raw_get_double (void *vstate);
 static void stdin_input_raw_set (void *vstate, unsigned long int s);
 
+#define SIR_BLOCK 262144        /* uints per block (1 MB) */
+#define SIR_NBLOCKS 8
+
+static struct {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  pthread_t thread;
+  int started;
+  unsigned int *buf;            /* SIR_NBLOCKS blocks of SIR_BLOCK uints */
+  size_t len[SIR_NBLOCKS];      /* uints in each full block */
+  unsigned long head;           /* blocks filled by the reader */
+  unsigned long tail;           /* blocks used up by the tests */
+  int waiting;                  /* the tests are waiting for a block (atomic) */
+  int eof;                      /* the reader is done (EOF or error) */
+  int err;                      /* errno of the read error, 0 for EOF */
+  unsigned int *cur;            /* the block being used up... */
+  size_t pos,n;                 /* ...its next uint and its length */
+  double source_stall;          /* seconds the tests waited for input */
+  double test_stall;            /* seconds the reader waited for room */
+} sir = {PTHREAD_MUTEX_INITIALIZER,PTHREAD_COND_INITIALIZER};
+
+static double sir_seconds()
+{
+
+ struct timeval tv;
+
+ gettimeofday(&tv,0);
+ return((double) tv.tv_sec + 1.0e-6*tv.tv_usec);
+
+}
+
+/*
+ * The prefetch thread.  It fills a block with as many read()s as it
+ * takes, and hands it over when it is full or (if the tests are already
+ * waiting) as soon as it holds a whole uint.  Bytes of a partial uint
+ * are carried over to the next block.
+ */
+static void *sir_reader(void *arg)
+{
+
+ unsigned char *block;
+ unsigned char cbuf[sizeof(unsigned int)];
+ size_t nbytes,carry;
+ ssize_t r;
+ double t0;
+
+ carry = 0;
+ while(1){
+
+   pthread_mutex_lock(&sir.mutex);
+   if(sir.head - sir.tail == SIR_NBLOCKS){
+     t0 = sir_seconds();
+     while(sir.head - sir.tail == SIR_NBLOCKS){
+       pthread_cond_wait(&sir.cond,&sir.mutex);
+     }
+     sir.test_stall += sir_seconds() - t0;
+   }
+   block = (unsigned char *)&sir.buf[(sir.head%SIR_NBLOCKS)*SIR_BLOCK];
+   pthread_mutex_unlock(&sir.mutex);
+
+   /*
+    * The block after a short one starts with its leftover bytes.
+    */
+   memcpy(block,cbuf,carry);
+   nbytes = carry;
+   while(nbytes < SIR_BLOCK*sizeof(unsigned int)){
+     r = read(0,block + nbytes,SIR_BLOCK*sizeof(unsigned int) - nbytes);
+     if(r < 0 && errno == EINTR) continue;
+     if(r <= 0){
+       pthread_mutex_lock(&sir.mutex);
+       sir.err = r < 0 ? errno : 0;
+       sir.len[sir.head%SIR_NBLOCKS] = nbytes/sizeof(unsigned int);
+       if(sir.len[sir.head%SIR_NBLOCKS]) sir.head++;
+       sir.eof = 1;
+       pthread_cond_broadcast(&sir.cond);
+       pthread_mutex_unlock(&sir.mutex);
+       return(0);
+     }
+     nbytes += r;
+     if(__atomic_load_n(&sir.waiting,__ATOMIC_ACQUIRE) && nbytes >= sizeof(unsigned int)) break;
+   }
+
+   pthread_mutex_lock(&sir.mutex);
+   sir.len[sir.head%SIR_NBLOCKS] = nbytes/sizeof(unsigned int);
+   carry = nbytes%sizeof(unsigned int);
+   memcpy(cbuf,block + nbytes - carry,carry);
+   sir.head++;
+   pthread_cond_broadcast(&sir.cond);
+   pthread_mutex_unlock(&sir.mutex);
+
+ }
+
+}
+
+/*
+ * Trade the block we have used up for the next full one, starting the
+ * reader if this is the first call.  We die at the end of the input
+ * exactly as the fread() version did.
+ */
+static void sir_next()
+{
+
+ double t0;
+
+ pthread_mutex_lock(&sir.mutex);
+ if(!sir.started){
+   sir.buf = (unsigned int *)malloc((size_t) SIR_NBLOCKS*SIR_BLOCK*sizeof(unsigned int));
+   if(sir.buf == 0 || pthread_create(&sir.thread,NULL,sir_reader,NULL) != 0){
+     fprintf(stderr,"# stdin_input_raw(): Error: cannot start the reader.\n");
+     exit(0);
+   }
+   pthread_detach(sir.thread);
+   sir.started = 1;
+ } else if(sir.cur){
+   sir.tail++;
+   pthread_cond_broadcast(&sir.cond);
+ }
+ sir.cur = 0;
+
+ if(sir.head == sir.tail && !sir.eof){
+   t0 = sir_seconds();
+   __atomic_store_n(&sir.waiting,1,__ATOMIC_RELEASE);
+   while(sir.head == sir.tail && !sir.eof){
+     pthread_cond_wait(&sir.cond,&sir.mutex);
+   }
+   __atomic_store_n(&sir.waiting,0,__ATOMIC_RELAXED);
+   sir.source_stall += sir_seconds() - t0;
+ }
+ if(sir.head == sir.tail){
+   if(sir.err == 0) {
+       fprintf(stderr,"# stdin_input_raw(): Error: EOF\n");
+   } else {
+       fprintf(stderr,"# stdin_input_raw(): Error: %s\n", strerror(sir.err));
+   }
+   exit(0);
+ }
+ sir.cur = &sir.buf[(sir.tail%SIR_NBLOCKS)*SIR_BLOCK];
+ sir.n = sir.len[sir.tail%SIR_NBLOCKS];
+ sir.pos = 0;
+ pthread_mutex_unlock(&sir.mutex);
+
+}
+
 static unsigned long int
 stdin_input_raw_get (void *vstate)
 {
-  unsigned int j;
-  if (fread(&j,sizeof(j),1,stdin) != 1) {
-      if (feof(stdin)) {
-          fprintf(stderr,"# stdin_input_raw(): Error: EOF\n");
-      } else {
-          fprintf(stderr,"# stdin_input_raw(): Error: %s\n", strerror(errno));
-      }
-      exit(0);
+  if (sir.pos == sir.n) sir_next();
+  /* printf("raw: %10u\n",sir.cur[sir.pos]); */
+  return sir.cur[sir.pos++];
+}
+
+/*
+ * Bulk version of stdin_input_raw_get(), straight out of the blocks.
+ */
+void
+stdin_input_raw_fill (void *vstate, unsigned int *buf, size_t n)
+{
+  size_t k;
+
+  while (n) {
+      if (sir.pos == sir.n) sir_next();
+      k = sir.n - sir.pos;
+      if (k > n) k = n;
+      memcpy(buf,&sir.cur[sir.pos],k*sizeof(unsigned int));
+      sir.pos += k;
+      buf += k;
+      n -= k;
   }
-  /* printf("raw: %10u\n",j); */
-  return j;
+}
+
+/*
+ * How long (in seconds) the tests have waited for input, and the input
+ * reader for the tests, so far.
+ */
+void
+stdin_input_get_stalls (gsl_rng *rng, double *source_stall, double *test_stall)
+{
+  pthread_mutex_lock(&sir.mutex);
+  *source_stall = sir.source_stall;
+  *test_stall = sir.test_stall;
+  pthread_mutex_unlock(&sir.mutex);
 }
 
 static double
@@ -49,3 +231,26 @@ static const gsl_rng_type stdin_input_raw_type =
  stdin_input_raw_get_double};
 
 const gsl_rng_type *gsl_rng_stdin_input_raw = &stdin_input_raw_type;
+
+/*
+ * stdin_input_raw64 is the same pipe read as 64 bit words (in host byte
+ * order), which as uints is the same stream on a little endian host, low
+ * half first.  It differs only in having a 64 bit fill, so that -H can
+ * pick out the low or high halves of the words.
+ */
+void
+stdin_input_raw64_fill64 (void *vstate, uint64_t *buf, size_t n)
+{
+  stdin_input_raw_fill(vstate,(unsigned int *) buf,2*n);
+}
+
+static const gsl_rng_type stdin_input_raw64_type =
+{"stdin_input_raw64",           /* name */
+ UINT_MAX,                      /* RAND_MAX */
+ 0,                             /* RAND_MIN */
+ 0,
+ stdin_input_raw_set,
+ stdin_input_raw_get,
+ stdin_input_raw_get_double};
+
+const gsl_rng_type *gsl_rng_stdin_input_raw64 = &stdin_input_raw64_type;
@@ -24,6 +24,11 @@
  */
 
 #include <dieharder/libdieharder.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SUPERKISS_X86 1
+#include <immintrin.h>
+#endif
 #define SUPERKISS_QMAX 41790
 #define GSL_MT19937_1999 14
 
@@ -79,6 +84,139 @@ superkiss_get (void *vstate)
 
 }
 
+/*
+ * m returns, using (and adding) q[0..m-1] as the Q part.
+ */
+static void superkiss_run_portable (superkiss_state_t *state, const unsigned int *q, unsigned int *buf, size_t m)
+{
+
+ unsigned int xcng = state->xcng, xs = state->xs;
+ size_t i;
+
+ for(i = 0;i < m;i++){
+   xcng = 69069 * xcng + 123;
+   xs ^= xs<<13;
+   xs ^= xs>>17;
+   xs ^= xs>>5;
+   buf[i] = q[i] + xcng + xs;
+ }
+ state->xcng = xcng;
+ state->xs = xs;
+
+}
+
+#ifdef SUPERKISS_X86
+/*
+ * The same, SUPERKISS_LANES*SUPERKISS_LANE returns at a time, with the
+ * SUPERKISS_LANES lanes of an AVX2 register each making SUPERKISS_LANE
+ * successive returns (see kiss_fill_avx2() in rng_kiss.c).  Lane j
+ * starts j*SUPERKISS_LANE steps ahead:  SUPERKISS_LANE steps of the LCG
+ * xcng are xcng -> SUPERKISS_XMUL*xcng + SUPERKISS_XADD, and of the
+ * xorshift xs the GF(2) matrix with columns superkiss_xsjump[].
+ */
+#define SUPERKISS_LANES 8
+#define SUPERKISS_LANE 256
+#define SUPERKISS_XMUL 0x40a68401U
+#define SUPERKISS_XADD 0xa9a57900U
+
+static const unsigned int superkiss_xsjump[32] = {
+ 0xb317313e,0x0d064c50,0xbdcda492,0xa5417fe7,0x66d2dcb4,0xce20009c,0x843492a0,0x4abf148b,
+ 0x8df6ea81,0x5ffbae04,0xc9daf1e6,0x0b85fe38,0x6ad0dc89,0x697886c4,0x9055ad32,0x7d024a48,
+ 0x202cb5b3,0x83bb5105,0xd10b838f,0xb2794a0c,0x825ed42e,0x3c6a29a5,0xeccff0d6,0xcc9ae5c0,
+ 0x7b5a27b4,0xf84d4342,0x9ba00c94,0x004762af,0xc21a3818,0xc3b2feb4,0xa868ca53,0x450aa412
+};
+
+__attribute__((target("avx2")))
+static void superkiss_run_avx2 (superkiss_state_t *state, const unsigned int *q, unsigned int *buf, size_t m)
+{
+
+ unsigned int xcng[SUPERKISS_LANES],xs[SUPERKISS_LANES];
+ unsigned int out[8*SUPERKISS_LANES] __attribute__((aligned(32)));
+ const __m256i xa = _mm256_set1_epi32(69069), xc = _mm256_set1_epi32(123);
+ __m256i X,S;
+ size_t i;
+ int j,k;
+
+ while(m >= SUPERKISS_LANES*SUPERKISS_LANE){
+
+   xcng[0] = state->xcng;
+   xs[0] = state->xs;
+   for(j = 1;j < SUPERKISS_LANES;j++){
+     xcng[j] = SUPERKISS_XMUL * xcng[j-1] + SUPERKISS_XADD;
+     xs[j] = 0;
+     for(k = 0;k < 32;k++){
+       if(xs[j-1] & (1U << k)) xs[j] ^= superkiss_xsjump[k];
+     }
+   }
+   X = _mm256_loadu_si256((const __m256i *) xcng);
+   S = _mm256_loadu_si256((const __m256i *) xs);
+
+   for(i = 0;i < SUPERKISS_LANE;i += 8){
+     for(k = 0;k < 8;k++){
+       X = _mm256_add_epi32(_mm256_mullo_epi32(X,xa),xc);
+       S = _mm256_xor_si256(S,_mm256_slli_epi32(S,13));
+       S = _mm256_xor_si256(S,_mm256_srli_epi32(S,17));
+       S = _mm256_xor_si256(S,_mm256_srli_epi32(S,5));
+       _mm256_store_si256((__m256i *)(out + 8*k),_mm256_add_epi32(X,S));
+     }
+     for(j = 0;j < SUPERKISS_LANES;j++){
+       for(k = 0;k < 8;k++){
+         buf[j*SUPERKISS_LANE + i + k] = q[j*SUPERKISS_LANE + i + k] + out[8*k + j];
+       }
+     }
+   }
+
+   _mm256_storeu_si256((__m256i *) xcng,X);
+   _mm256_storeu_si256((__m256i *) xs,S);
+   state->xcng = xcng[SUPERKISS_LANES-1];
+   state->xs = xs[SUPERKISS_LANES-1];
+   q += SUPERKISS_LANES*SUPERKISS_LANE;
+   buf += SUPERKISS_LANES*SUPERKISS_LANE;
+   m -= SUPERKISS_LANES*SUPERKISS_LANE;
+
+ }
+ superkiss_run_portable(state,q,buf,m);
+
+}
+#endif
+
+/*
+ * superkiss_get() n times, a run of Q (up to the next refill) at a
+ * time, with the fastest kernel this CPU can run (picked once).
+ */
+typedef void (*superkiss_run_t)(superkiss_state_t *state, const unsigned int *q, unsigned int *buf, size_t m);
+static superkiss_run_t superkiss_run = 0;
+
+void superkiss_fill (void *vstate, unsigned int *buf, size_t n)
+{
+
+ superkiss_state_t *state = vstate;
+ size_t m;
+
+ if(superkiss_run == 0){
+   superkiss_run_t f = superkiss_run_portable;
+#ifdef SUPERKISS_X86
+   __builtin_cpu_init();
+   if(__builtin_cpu_supports("avx2")) f = superkiss_run_avx2;
+#endif
+   superkiss_run = f;
+ }
+
+ while(n){
+   if(state->indx >= SUPERKISS_QMAX){
+     superkiss_refill(vstate);
+     state->indx = 0;
+   }
+   m = SUPERKISS_QMAX - state->indx;
+   if(m > n) m = n;
+   superkiss_run(state,&state->Q[state->indx],buf,m);
+   state->indx += m;
+   buf += m;
+   n -= m;
+ }
+
+}
+
 static double superkiss_get_double (void *vstate)
 {
 
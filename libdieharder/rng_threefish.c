@@ -24,15 +24,29 @@
 #define STATE_BLOCKS (1)
 #define BLOCKS_SIZE (64 * STATE_BLOCKS)
 
+// Blocks made per refill of the output buffer
+#define OUT_BLOCKS (32)
+#define OUT_SIZE (BLOCKS_SIZE * OUT_BLOCKS)
+
 #define Threefish_512_Process_Blocks(a,b,c,d) Threefish_512_Process_Blocks64(a,b,c,d)
 
 /*
  * This is a wrapping of the Threefish algorithm as a generator
+ *
+ * Like AES_OFB, it is Threefish-512 in OFB mode:  each block of output
+ * is the encryption of the one before.  Handing Threefish_512_Process
+ * _Blocks() the buffer as input and the buffer one block on as output
+ * makes it run the whole chain, OUT_BLOCKS blocks, in one call (with
+ * one key schedule).  out[0] holds the last block of the previous
+ * refill, and the rands are served from out[BLOCKS_SIZE] on, 32 bits
+ * at a time by threefish_get() or 64 at a time by threefish_get_long()
+ * and threefish_fill64().  They share the buffer, so mixing them skips
+ * no bits.
  */
 
 typedef struct {
 	Threefish_512_Ctxt_t ctx;
-	unsigned char block[BLOCKS_SIZE];
+	unsigned char out[BLOCKS_SIZE + OUT_SIZE];
 	short int pos;
 } Threefish_state_t;
 
@@ -41,17 +55,34 @@ double threefish_get_double (void *vstate);
 void threefish_set (void *vstate, unsigned long int s);
 
 #ifndef BADRNG
+static void threefish_refill (Threefish_state_t *state) {
+	memcpy(state->out, state->out + OUT_SIZE, BLOCKS_SIZE);
+	Threefish_512_Process_Blocks(&(state->ctx), state->out, state->out + BLOCKS_SIZE, OUT_BLOCKS);
+	state->pos = BLOCKS_SIZE;
+}
+
+/*
+ * Copy the next n bytes of the stream to buf.
+ */
+static void threefish_bytes (Threefish_state_t *state, unsigned char *buf, size_t n) {
+	size_t k;
+
+	while (n) {
+		if (state->pos == BLOCKS_SIZE + OUT_SIZE) threefish_refill(state);
+		k = BLOCKS_SIZE + OUT_SIZE - state->pos;
+		if (k > n) k = n;
+		memcpy(buf, state->out + state->pos, k);
+		state->pos += k;
+		buf += k;
+		n -= k;
+	}
+}
+
 unsigned long int threefish_get_long (void *vstate) {
 	Threefish_state_t *state = vstate;
 	unsigned long int ret;
 
-	if (state->pos + sizeof(unsigned long int) > BLOCKS_SIZE) {
-		Threefish_512_Process_Blocks(&(state->ctx), state->block, state->block, STATE_BLOCKS);
-		state->pos = 0;
-	}
-
-	ret = *((unsigned long int *) (state->block + state->pos));
-	state->pos += sizeof(unsigned long int);
+	threefish_bytes(state, (unsigned char *) &ret, sizeof(ret));
 
 	return(ret);
 }
@@ -60,12 +91,11 @@ unsigned long int threefish_get (void *vstate) {
 	Threefish_state_t *state = vstate;
 	unsigned int ret;
 
-	if (state->pos + sizeof(ret) > BLOCKS_SIZE) {
-		Threefish_512_Process_Blocks(&(state->ctx), state->block, state->block, STATE_BLOCKS);
-		state->pos = 0;
+	if (state->pos + sizeof(ret) > BLOCKS_SIZE + OUT_SIZE) {
+		threefish_refill(state);
 	}
 
-	ret = *((unsigned int *) (state->block + state->pos));
+	ret = *((unsigned int *) (state->out + state->pos));
 	state->pos += sizeof(ret);
 
 //	ret &= 0x7fffffff;
@@ -73,6 +103,19 @@ unsigned long int threefish_get (void *vstate) {
 }
 
 
+/*
+ * Bulk versions of threefish_get() and threefish_get_long(): copy whole
+ * runs of words out of the buffer.
+ */
+void threefish_fill (void *vstate, unsigned int *buf, size_t n) {
+	threefish_bytes(vstate, (unsigned char *) buf, n * sizeof(unsigned int));
+}
+
+void threefish_fill64 (void *vstate, uint64_t *buf, size_t n) {
+	threefish_bytes(vstate, (unsigned char *) buf, n * sizeof(uint64_t));
+}
+
+
 double threefish_get_double (void *vstate) {
 //	return threefish_get_long(vstate) / (double) ULONG_MAX;
 	return (double) threefish_get(vstate) / (double) (UINT_MAX >> 0);
@@ -101,16 +144,18 @@ void threefish_set (void *vstate, unsigned long int s) {
 	 * different way.
 	*((unsigned long int *) state->block) = s;
 	 */
-	blockptr = (unsigned long int*) &state->block;
+	blockptr = (unsigned long int*) &state->out[BLOCKS_SIZE];
 	*blockptr = s;
-	Threefish_512_Process_Blocks(&(state->ctx), state->block, state->block, 1);
-
-	for (i = 1; i < STATE_BLOCKS; i++) {
-		state->ctx.T[0] = i;
-		Threefish_512_Process_Blocks(&(state->ctx), state->block, state->block+(i*64), 1);
-	}
+	Threefish_512_Process_Blocks(&(state->ctx), state->out + BLOCKS_SIZE, state->out + BLOCKS_SIZE, 1);
 	state->ctx.T[0] = 112;
 
+	/*
+	 * That is the first block of output.  Run the chain on from it to
+	 * fill the rest of the buffer.
+	 */
+	Threefish_512_Process_Blocks(&(state->ctx), state->out + BLOCKS_SIZE, state->out + 2*BLOCKS_SIZE, OUT_BLOCKS - 1);
+	state->pos = BLOCKS_SIZE;
+
 	return;
 }
 
@@ -73,12 +73,6 @@ static unsigned long int uvag_get (void *vstate);
 static double uvag_get_double (void *vstate);
 static void uvag_set (void *vstate, unsigned long int s);
 
-typedef struct
-  {
-  int i;
-  }
-uvag_state_t;
-
 /*
  * UVAG specific defines.
  *
@@ -92,12 +86,27 @@ uvag_state_t;
 #define WORD sizeof(TYPE)
 
 /*
- * Global variables and data for UVAG
+ * The variables and data for UVAG, once globals, so that every instance
+ * has its own.
  */
+typedef struct
+  {
+  TYPE rndint;
+  unsigned char sindex, svec[255 + WORD];  /* 256 overlapping TYPE seeds */
+  }
+uvag_state_t;
 
-TYPE *rp;
-TYPE rndint;
-unsigned char sindex, svec[255 + WORD];  /* 256 overlapping TYPE seeds */
+/*
+ * One step.  The TYPE at svec + svec[sindex] is generally unaligned, so
+ * we go through memcpy() (which the compiler turns into a plain load or
+ * store where the CPU allows it).
+ */
+#define UVAG_STEP(svec,sindex,rndint,rp,r) \
+  rp = svec + svec[sindex+=1]; \
+  memcpy(&r,rp,WORD); \
+  r += rndint; \
+  memcpy(rp,&r,WORD); \
+  rndint += r;
 
 static inline unsigned long int
 uvag_get (void *vstate)
@@ -106,9 +115,35 @@ uvag_get (void *vstate)
   /*
    * Returns a 32-bit unsigned integer produced by the UVAG
    */
-  rp = (TYPE *)(svec + svec[sindex+=1]);
-  rndint += *rp += rndint;
-  return rndint;
+  uvag_state_t *state = (uvag_state_t *) vstate;
+  unsigned char *rp;
+  TYPE r;
+
+  UVAG_STEP(state->svec,state->sindex,state->rndint,rp,r);
+  return state->rndint;
+
+}
+
+/*
+ * uvag_get() n times, with rndint and sindex kept in registers.  Every
+ * step may read back what the last one just wrote, so this cannot be
+ * split into lanes.
+ */
+void uvag_fill (void *vstate, unsigned int *buf, size_t n)
+{
+
+  uvag_state_t *state = (uvag_state_t *) vstate;
+  unsigned char *svec = state->svec, *rp;
+  unsigned char sindex = state->sindex;
+  TYPE rndint = state->rndint, r;
+  size_t i;
+
+  for(i=0;i<n;i++){
+    UVAG_STEP(svec,sindex,rndint,rp,r);
+    buf[i] = rndint;
+  }
+  state->sindex = sindex;
+  state->rndint = rndint;
 
 }
 
@@ -121,11 +156,12 @@ uvag_get_double (void *vstate)
 static void uvag_set (void *vstate, unsigned long int s) {
 
  /* Initialize automaton using specified seed. */
- uvag_state_t *state __attribute__((unused)) = (uvag_state_t *) vstate;
+ uvag_state_t *state = (uvag_state_t *) vstate;
  
  uint i, array_len = 255 + WORD, tot, seed_seed, tmp8;
- unsigned char key[256], *kp, temp;
+ unsigned char key[256], *kp, temp, *svec = state->svec;
  gsl_rng *seed_rng;    /* random number generator used to seed uvag */
+ dh_context *seed_ctx; /* ...and its own bit buffers */
 
  /*
   * Preload the array with 1-byte integers
@@ -142,23 +178,19 @@ static void uvag_set (void *vstate, unsigned long int s) {
   * string from a single permitted seed.  Note that type 12 is the
   * mt19937_1999 generator, basically one of the best in the world -- not
   * that it matters.
+  *
+  * The bits are drawn through a context of its own, NOT the global one
+  * (whose leftover bits made the key depend on whatever had been run
+  * before), so the key depends on s alone and instances can be seeded
+  * from several threads at once.
   */
  seed_rng = gsl_rng_alloc(dh_rng_types[14]);
  seed_seed = s;
  gsl_rng_set(seed_rng,seed_seed);
- random_max = gsl_rng_max(seed_rng);
- rmax = random_max;
- rmax_bits = 0;
- rmax_mask = 0;
- while(rmax){
-   rmax >>= 1;
-   rmax_mask = rmax_mask << 1;
-   rmax_mask++;
-   rmax_bits++;
- }
+ seed_ctx = dh_context_alloc(seed_rng);
  for(i=0;i<256;i++){
    /* if(i%32 == 0) printf("\n"); */
-   get_rand_bits(&tmp8,sizeof(uint),8,seed_rng);
+   get_rand_bits_ctx(&tmp8,sizeof(uint),8,seed_ctx);
    if(i!=255){
      key[i] = tmp8;
    } else {
@@ -167,6 +199,8 @@ static void uvag_set (void *vstate, unsigned long int s) {
    /* printf("%02x",key[i]); */
  }
  /* printf("\n"); */
+ dh_context_free(seed_ctx);
+ gsl_rng_free(seed_rng);
 
  kp = key;
  tot = 0;
@@ -190,8 +224,8 @@ static void uvag_set (void *vstate, unsigned long int s) {
  printf("\n");
  */
 
- sindex = 0;
- rndint = 0;
+ state->sindex = 0;
+ state->rndint = 0;
 
 }
 
@@ -0,0 +1,182 @@
+/*
+ *  rng_xoroshiro128p.c
+ *
+ *  xoroshiro128+ 1.0, from:
+ *
+ * D. Blackman and S. Vigna, "Scrambled Linear Pseudorandom Number
+ * Generators", ACM Trans. Math. Softw. 47 (2021),
+ *
+ * after the public domain C at http://prng.di.unimi.it/.  The state is
+ * 128 bits, the period 2^128-1.  xoroshiro128p_jump() advances the state
+ * by 2^64 steps, so the k'th substream of a seed (k jumps from the seed)
+ * never runs into the next for 2^64 64 bit returns.
+ *
+ * Every 64 bit return is handed out as two uints, low half first.  The
+ * authors warn that the lowest bits of + are (nearly) linear and fail
+ * binary rank and linear complexity tests; that is not our problem to
+ * hide, so we don't.
+ */
+
+#include <dieharder/libdieharder.h>
+
+static unsigned long int xoroshiro128p_get (void *vstate);
+static double xoroshiro128p_get_double (void *vstate);
+static void xoroshiro128p_set (void *vstate, unsigned long int s);
+
+typedef struct {
+ uint64_t s[2];
+ uint32_t hi;           /* The unused high half of the last return */
+ int have_hi;
+} xoroshiro128p_state_t;
+
+static inline uint64_t rotl(const uint64_t x, int k)
+{
+ return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t xoroshiro128p_next(uint64_t *s)
+{
+
+ const uint64_t s0 = s[0];
+ uint64_t s1 = s[1];
+ const uint64_t result = s0 + s1;
+
+ s1 ^= s0;
+ s[0] = rotl(s0, 24) ^ s1 ^ (s1 << 16);
+ s[1] = rotl(s1, 37);
+ return result;
+
+}
+
+static unsigned long int xoroshiro128p_get (void *vstate)
+{
+
+ xoroshiro128p_state_t *state = vstate;
+ uint64_t z;
+
+ if(state->have_hi){
+   state->have_hi = 0;
+   return state->hi;
+ }
+ z = xoroshiro128p_next(state->s);
+ state->hi = z >> 32;
+ state->have_hi = 1;
+ return (uint32_t) z;
+
+}
+
+/*
+ * xoroshiro128p_get() n times, with the state kept in registers.
+ */
+void xoroshiro128p_fill (void *vstate, unsigned int *buf, size_t n)
+{
+
+ xoroshiro128p_state_t *state = vstate;
+ uint64_t s[2],z;
+
+ if(n && state->have_hi){
+   *buf++ = state->hi;
+   state->have_hi = 0;
+   n--;
+ }
+ s[0] = state->s[0];
+ s[1] = state->s[1];
+ for(;n >= 2;n -= 2){
+   z = xoroshiro128p_next(s);
+   *buf++ = (uint32_t) z;
+   *buf++ = z >> 32;
+ }
+ if(n){
+   z = xoroshiro128p_next(s);
+   *buf = (uint32_t) z;
+   state->hi = z >> 32;
+   state->have_hi = 1;
+ }
+ state->s[0] = s[0];
+ state->s[1] = s[1];
+
+}
+
+/*
+ * The next n whole 64 bit returns (see dh_rng_fill64()).  A pending high
+ * half is dropped.
+ */
+void xoroshiro128p_fill64 (void *vstate, uint64_t *buf, size_t n)
+{
+
+ xoroshiro128p_state_t *state = vstate;
+ uint64_t s[2];
+
+ s[0] = state->s[0];
+ s[1] = state->s[1];
+ while(n--) *buf++ = xoroshiro128p_next(s);
+ state->s[0] = s[0];
+ state->s[1] = s[1];
+ state->have_hi = 0;
+
+}
+
+/*
+ * Advance the state by 2^64 steps.  A pending high half is dropped.
+ */
+void xoroshiro128p_jump (void *vstate)
+{
+
+ static const uint64_t JUMP[] = { 0xdf900294d8f554a5ULL, 0x170865df4b3201fcULL };
+ xoroshiro128p_state_t *state = vstate;
+ uint64_t s0 = 0, s1 = 0;
+ int i,b;
+
+ for(i = 0;i < 2;i++){
+   for(b = 0;b < 64;b++){
+     if(JUMP[i] & (1ULL << b)){
+       s0 ^= state->s[0];
+       s1 ^= state->s[1];
+     }
+     xoroshiro128p_next(state->s);
+   }
+ }
+ state->s[0] = s0;
+ state->s[1] = s1;
+ state->have_hi = 0;
+
+}
+
+static double xoroshiro128p_get_double (void *vstate)
+{
+  return (double) xoroshiro128p_get (vstate) / (double) UINT_MAX;
+}
+
+static void xoroshiro128p_set (void *vstate, unsigned long int s)
+{
+
+ xoroshiro128p_state_t *state = vstate;
+ uint64_t x = s;
+
+ state->s[0] = splitmix64_next(&x);
+ state->s[1] = splitmix64_next(&x);
+ state->have_hi = 0;
+
+}
+
+/*
+ * Seed with seed and jump k times (see above).
+ */
+void xoroshiro128p_substream (void *vstate, unsigned long int seed, unsigned long int k)
+{
+
+ xoroshiro128p_set(vstate,seed);
+ while(k--) xoroshiro128p_jump(vstate);
+
+}
+
+static const gsl_rng_type xoroshiro128p_type =
+{"xoroshiro128plus",		/* name */
+ UINT_MAX,			/* RAND_MAX */
+ 0,				/* RAND_MIN */
+ sizeof (xoroshiro128p_state_t),
+ &xoroshiro128p_set,
+ &xoroshiro128p_get,
+ &xoroshiro128p_get_double};
+
+const gsl_rng_type *gsl_rng_xoroshiro128p = &xoroshiro128p_type;
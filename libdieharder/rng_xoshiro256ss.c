@@ -0,0 +1,200 @@
+/*
+ *  rng_xoshiro256ss.c
+ *
+ *  xoshiro256** 1.0, from:
+ *
+ * D. Blackman and S. Vigna, "Scrambled Linear Pseudorandom Number
+ * Generators", ACM Trans. Math. Softw. 47 (2021),
+ *
+ * after the public domain C at http://prng.di.unimi.it/.  The state is
+ * 256 bits, the period 2^256-1.  xoshiro256ss_jump() advances the state
+ * by 2^128 steps, so the k'th substream of a seed (k jumps from the
+ * seed) never runs into the next for 2^128 64 bit returns.  Jumping k
+ * times costs k jumps, which is fine for the few hundred streams of a
+ * parallel run.
+ *
+ * Every 64 bit return is handed out as two uints, low half first, and
+ * the state is seeded from splitmix64_next() as the authors recommend.
+ */
+
+#include <dieharder/libdieharder.h>
+
+static unsigned long int xoshiro256ss_get (void *vstate);
+static double xoshiro256ss_get_double (void *vstate);
+static void xoshiro256ss_set (void *vstate, unsigned long int s);
+
+typedef struct {
+ uint64_t s[4];
+ uint32_t hi;           /* The unused high half of the last return */
+ int have_hi;
+} xoshiro256ss_state_t;
+
+static inline uint64_t rotl(const uint64_t x, int k)
+{
+ return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t xoshiro256ss_next(uint64_t *s)
+{
+
+ const uint64_t result = rotl(s[1] * 5, 7) * 9;
+ const uint64_t t = s[1] << 17;
+
+ s[2] ^= s[0];
+ s[3] ^= s[1];
+ s[1] ^= s[2];
+ s[0] ^= s[3];
+ s[2] ^= t;
+ s[3] = rotl(s[3], 45);
+ return result;
+
+}
+
+static unsigned long int xoshiro256ss_get (void *vstate)
+{
+
+ xoshiro256ss_state_t *state = vstate;
+ uint64_t z;
+
+ if(state->have_hi){
+   state->have_hi = 0;
+   return state->hi;
+ }
+ z = xoshiro256ss_next(state->s);
+ state->hi = z >> 32;
+ state->have_hi = 1;
+ return (uint32_t) z;
+
+}
+
+/*
+ * xoshiro256ss_get() n times, with the state kept in registers.
+ */
+void xoshiro256ss_fill (void *vstate, unsigned int *buf, size_t n)
+{
+
+ xoshiro256ss_state_t *state = vstate;
+ uint64_t s[4],z;
+
+ if(n && state->have_hi){
+   *buf++ = state->hi;
+   state->have_hi = 0;
+   n--;
+ }
+ s[0] = state->s[0];
+ s[1] = state->s[1];
+ s[2] = state->s[2];
+ s[3] = state->s[3];
+ for(;n >= 2;n -= 2){
+   z = xoshiro256ss_next(s);
+   *buf++ = (uint32_t) z;
+   *buf++ = z >> 32;
+ }
+ if(n){
+   z = xoshiro256ss_next(s);
+   *buf = (uint32_t) z;
+   state->hi = z >> 32;
+   state->have_hi = 1;
+ }
+ state->s[0] = s[0];
+ state->s[1] = s[1];
+ state->s[2] = s[2];
+ state->s[3] = s[3];
+
+}
+
+/*
+ * The next n whole 64 bit returns (see dh_rng_fill64()).  A pending high
+ * half is dropped.
+ */
+void xoshiro256ss_fill64 (void *vstate, uint64_t *buf, size_t n)
+{
+
+ xoshiro256ss_state_t *state = vstate;
+ uint64_t s[4];
+
+ s[0] = state->s[0];
+ s[1] = state->s[1];
+ s[2] = state->s[2];
+ s[3] = state->s[3];
+ while(n--) *buf++ = xoshiro256ss_next(s);
+ state->s[0] = s[0];
+ state->s[1] = s[1];
+ state->s[2] = s[2];
+ state->s[3] = s[3];
+ state->have_hi = 0;
+
+}
+
+/*
+ * Advance the state by 2^128 steps.  A pending high half is dropped.
+ */
+void xoshiro256ss_jump (void *vstate)
+{
+
+ static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                  0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+ xoshiro256ss_state_t *state = vstate;
+ uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+ int i,b;
+
+ for(i = 0;i < 4;i++){
+   for(b = 0;b < 64;b++){
+     if(JUMP[i] & (1ULL << b)){
+       s0 ^= state->s[0];
+       s1 ^= state->s[1];
+       s2 ^= state->s[2];
+       s3 ^= state->s[3];
+     }
+     xoshiro256ss_next(state->s);
+   }
+ }
+ state->s[0] = s0;
+ state->s[1] = s1;
+ state->s[2] = s2;
+ state->s[3] = s3;
+ state->have_hi = 0;
+
+}
+
+static double xoshiro256ss_get_double (void *vstate)
+{
+  return (double) xoshiro256ss_get (vstate) / (double) UINT_MAX;
+}
+
+static void xoshiro256ss_set (void *vstate, unsigned long int s)
+{
+
+ xoshiro256ss_state_t *state = vstate;
+ uint64_t x = s;
+
+ /* splitmix64 never returns four zeros in a row, so the state is valid */
+ state->s[0] = splitmix64_next(&x);
+ state->s[1] = splitmix64_next(&x);
+ state->s[2] = splitmix64_next(&x);
+ state->s[3] = splitmix64_next(&x);
+ state->have_hi = 0;
+
+}
+
+/*
+ * Seed with seed and jump k times (see above).
+ */
+void xoshiro256ss_substream (void *vstate, unsigned long int seed, unsigned long int k)
+{
+
+ xoshiro256ss_set(vstate,seed);
+ while(k--) xoshiro256ss_jump(vstate);
+
+}
+
+static const gsl_rng_type xoshiro256ss_type =
+{"xoshiro256starstar",		/* name */
+ UINT_MAX,			/* RAND_MAX */
+ 0,				/* RAND_MIN */
+ sizeof (xoshiro256ss_state_t),
+ &xoshiro256ss_set,
+ &xoshiro256ss_get,
+ &xoshiro256ss_get_double};
+
+const gsl_rng_type *gsl_rng_xoshiro256ss = &xoshiro256ss_type;
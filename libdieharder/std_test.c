@@ -6,6 +6,7 @@
  */
 
 #include <dieharder/libdieharder.h>
+#include <pthread.h>
 
 /*
  * A standard test returns a single-pass p-value as an end result.
@@ -42,8 +43,19 @@
  * for psamples passes.  dtest is a pointer to a struct containing
  * the test description and default values for tsamples and psamples.
  * This should be called before a test is started in the UI.
+ *
+ * create_test() runs the test in the global context, i.e. on the
+ * global rng with the global run parameters.  Use create_test_ctx()
+ * to run it on a context of your own (e.g. one per thread).
  */
 Test **create_test(Dtest *dtest, uint tsamples,uint psamples)
+{
+
+ return(create_test_ctx(dh_global_context(),dtest,tsamples,psamples));
+
+}
+
+Test **create_test_ctx(dh_context *ctx, Dtest *dtest, uint tsamples,uint psamples)
 {
 
  uint i,j;
@@ -80,13 +92,13 @@ Test **create_test(Dtest *dtest, uint tsamples,uint psamples)
     * for psamples that permits one to scale the standard number of psamples
     * in an -a(ll) run by multiply_p.
     */
-   if(all == YES || tsamples == 0){
+   if(ctx->all == YES || tsamples == 0){
      newtest[i]->tsamples = dtest->tsamples_std;
    } else {
      newtest[i]->tsamples = tsamples;
    }
-   if(all == YES || psamples == 0){
-     newtest[i]->psamples = dtest->psamples_std*multiply_p;
+   if(ctx->all == YES || psamples == 0){
+     newtest[i]->psamples = dtest->psamples_std*ctx->multiply_p;
 	 if (newtest[i]->psamples < 1) newtest[i]->psamples = 1;
    } else {
      newtest[i]->psamples = psamples;
@@ -95,13 +107,16 @@ Test **create_test(Dtest *dtest, uint tsamples,uint psamples)
    /* Give ntuple an initial value of zero; most tests will set it. */
    newtest[i]->ntuple = 0;
 
+   /* Every test in the vector shares the one context */
+   newtest[i]->ctx = ctx;
+
    /*
     * Now we can malloc space for the pvalues vector, and a
     * single (80-column) LINE for labels for the pvalues.  We default
     * the label to a line of #'s.
     */
-   if(Xtrategy != 0 && Xoff > newtest[i]->psamples){
-     pcutoff = Xoff;
+   if(ctx->Xtrategy != 0 && ctx->Xoff > newtest[i]->psamples){
+     pcutoff = ctx->Xoff;
    } else {
      pcutoff = newtest[i]->psamples;
    }
@@ -120,7 +135,7 @@ Test **create_test(Dtest *dtest, uint tsamples,uint psamples)
 
    MYDEBUG(D_STD_TEST){
      printf("Allocated and set newtest->tsamples = %d\n",newtest[i]->tsamples);
-     printf("Xtrategy = %u -> pcutoff = %u\n",Xtrategy,pcutoff);
+     printf("Xtrategy = %u -> pcutoff = %u\n",ctx->Xtrategy,pcutoff);
      printf("Allocated and set newtest->psamples = %d\n",newtest[i]->psamples);
    }
 
@@ -175,15 +190,16 @@ void clear_test(Dtest *dtest, Test **test)
 {
 
  int i;
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * reset psamples and clear the ks_pvalues
   */
  for(i=0;i<dtest->nkps;i++){
-   if(all == YES || psamples == 0){
-     test[i]->psamples = dtest->psamples_std*multiply_p;
+   if(ctx->all == YES || ctx->psamples == 0){
+     test[i]->psamples = dtest->psamples_std*ctx->multiply_p;
    } else {
-     test[i]->psamples = psamples;
+     test[i]->psamples = ctx->psamples;
    }
    test[i]->ks_pvalue = 0.0;
  }
@@ -195,6 +211,157 @@ void clear_test(Dtest *dtest, Test **test)
    
 }
 
+/*
+ * The psamples of a test are independent, so with ctx->jobs > 1 they can
+ * be run on several threads at once.  Every worker gets its own instance
+ * of the generator, its own context and its own copy of the Test vector,
+ * sharing only the pvalues vectors (of which each psample fills its own
+ * slot).  To make the results independent of the number of threads and
+ * of which thread happens to run which psample, the generator is
+ * reseeded for each psample i and the bit buffers are emptied.  A
+ * generator with substreams (see dh_rng_substream()) gets substream i of
+ * ctx->seed, which is guaranteed not to overlap any other psample's;
+ * any other gets the seed dh_seed_derive(ctx->seed,i).  The p-values are
+ * therefore NOT the same as those of a serial run, but -S seed -j N gives
+ * the same p-values for any N > 1.
+ *
+ * The first psample is run by the calling thread before any other thread
+ * is started, and what it sets in its Test structs for display (ntuple
+ * and the like) is copied back to the caller.  This does NOT protect
+ * anything a test keeps in static variables:  every psample runs
+ * concurrently with the others, so a test must keep its working storage
+ * on the stack or in its context (see dh_context_workspace()).
+ */
+typedef struct {
+  Dtest *dtest;
+  Test **test;                 /* The caller's tests */
+  uint next;                   /* Next psample to run */
+  uint imax;                   /* One past the last psample to run */
+  pthread_mutex_t lock;
+} Psample_pool;
+
+typedef struct {
+  Psample_pool *pool;
+  gsl_rng *rng;
+  dh_context *ctx;
+  Test **test;                 /* This worker's copy of the Test vector */
+} Psample_worker;
+
+static void psample_worker_init(Psample_worker *w,Psample_pool *pool)
+{
+
+ uint j;
+ dh_context *ctx = pool->test[0]->ctx;
+
+ w->pool = pool;
+ w->rng = gsl_rng_alloc(ctx->rng->type);
+ w->ctx = dh_context_clone(ctx,w->rng);
+ w->test = (Test **)malloc((size_t) pool->dtest->nkps*sizeof(Test *));
+ for(j=0;j<pool->dtest->nkps;j++){
+   w->test[j] = (Test *)malloc(sizeof(Test));
+   memcpy(w->test[j],pool->test[j],sizeof(Test));
+   w->test[j]->ctx = w->ctx;
+ }
+
+}
+
+static void psample_worker_free(Psample_worker *w)
+{
+
+ uint j;
+
+ for(j=0;j<w->pool->dtest->nkps;j++){
+   free(w->test[j]);
+ }
+ free(w->test);
+ dh_context_free(w->ctx);
+ dh_rng_free(w->rng);
+
+}
+
+static void psample_run(Psample_worker *w,uint i)
+{
+
+ if(!dh_rng_substream(w->rng,w->ctx->seed,i)){
+   gsl_rng_set(w->rng,dh_seed_derive(w->ctx->seed,i));
+ }
+ dh_context_reset_bits(w->ctx);
+ w->pool->dtest->test(w->test,i);
+
+}
+
+static void *psample_thread(void *arg)
+{
+
+ Psample_worker *w = (Psample_worker *) arg;
+ Psample_pool *pool = w->pool;
+ uint i;
+
+ while(1){
+   pthread_mutex_lock(&pool->lock);
+   i = pool->next++;
+   pthread_mutex_unlock(&pool->lock);
+   if(i >= pool->imax) break;
+   psample_run(w,i);
+ }
+
+ return(0);
+
+}
+
+void add_2_test_parallel(Dtest *dtest, Test **test, uint imin, uint imax)
+{
+
+ uint j,t,nthreads;
+ Psample_pool pool;
+ Psample_worker *workers;
+ pthread_t *threads;
+
+ nthreads = test[0]->ctx->jobs;
+ if(nthreads > imax - imin) nthreads = imax - imin;
+
+ pool.dtest = dtest;
+ pool.test = test;
+ pool.next = imin + 1;
+ pool.imax = imax;
+ pthread_mutex_init(&pool.lock,NULL);
+
+ workers = (Psample_worker *)malloc(nthreads*sizeof(Psample_worker));
+ threads = (pthread_t *)malloc(nthreads*sizeof(pthread_t));
+ for(t=0;t<nthreads;t++){
+   psample_worker_init(&workers[t],&pool);
+ }
+
+ /*
+  * The first psample, alone.  Whatever the test sets in its Test
+  * structs for display (ntuple and the like) comes back from here.
+  */
+ psample_run(&workers[0],imin);
+ for(j=0;j<dtest->nkps;j++){
+   test[j]->ntuple = workers[0].test[j]->ntuple;
+   test[j]->tsamples = workers[0].test[j]->tsamples;
+ }
+
+ MYDEBUG(D_STD_TEST){
+   printf("# add_2_test_parallel(): running psamples %u to %u on %u threads\n",imin+1,imax-1,nthreads);
+ }
+ for(t=0;t<nthreads;t++){
+   if(pthread_create(&threads[t],NULL,psample_thread,&workers[t]) != 0){
+     fprintf(stderr,"Error: add_2_test_parallel() cannot create thread %u.\n",t);
+     exit(1);
+   }
+ }
+ for(t=0;t<nthreads;t++){
+   pthread_join(threads[t],NULL);
+   psample_worker_free(&workers[t]);
+ }
+
+ free(threads);
+ free(workers);
+ pthread_mutex_destroy(&pool.lock);
+
+}
+
 /*
  * Test To Destruction (TTD) or Resolve Ambiguity (RA) modes require one
  * to iterate, adding psamples until:
@@ -209,13 +376,15 @@ void clear_test(Dtest *dtest, Test **test)
  * is called by std_test() in two modes -- first call and TTD/RA (add more
  * samples) mode.  This is completely automagic, though.
  *
- * Note that Xoff MUST remain global, if nothing else.  Otherwise we
- * can run out of allocated headroom in the pvalues vector.
+ * Note that Xoff MUST remain fixed for the life of the test (it lives
+ * in the test's context).  Otherwise we can run out of allocated
+ * headroom in the pvalues vector.
  */
 void add_2_test(Dtest *dtest, Test **test, int count)
 {
 
  uint i,j,imax;
+ dh_context *ctx = test[0]->ctx;
 
 
  /*
@@ -224,10 +393,14 @@ void add_2_test(Dtest *dtest, Test **test, int count)
   * of how many samples we have at the end of it all.
   */
  imax = test[0]->psamples + count;
- if(imax > Xoff) imax = Xoff;
+ if(imax > ctx->Xoff) imax = ctx->Xoff;
  count = imax - test[0]->psamples;
- for(i = test[0]->psamples; i < imax; i++){
-   dtest->test(test,i);
+ if(ctx->jobs > 1 && count > 1 && dh_rng_can_clone(ctx->rng)){
+   add_2_test_parallel(dtest,test,test[0]->psamples,imax);
+ } else {
+   for(i = test[0]->psamples; i < imax; i++){
+     dtest->test(test,i);
+   }
  }
 
  for(j = 0;j < dtest->nkps;j++){
@@ -237,7 +410,7 @@ void add_2_test(Dtest *dtest, Test **test, int count)
     */
    test[j]->psamples += count;
 
-   if(ks_test >= 3){
+   if(ctx->ks_test >= 3){
      /*
       * This (Kuiper KS) can be selected with -k 3 from the command line.
       * Generally it is ignored.  All smaller values of ks_test are passed
@@ -269,6 +442,12 @@ void std_test(Dtest *dtest, Test **test)
  int j,count;
  double pmax = 0.0;
 
+ /*
+  * A UI working through the globals may have changed them since
+  * create_test(), so bring the shim context up to date.
+  */
+ if(test[0]->ctx->global) dh_global_context();
+
  /*
   * First we see if this is the first call.  If it is, we save
   * test[0]->psamples as count, then call add_2_test().  We determine
@@ -287,7 +466,7 @@ void std_test(Dtest *dtest, Test **test)
    }
  } else {
    /* Add Xstep more samples */
-   count = Xstep;
+   count = test[0]->ctx->Xstep;
  }
 
  add_2_test(dtest,test,count);
@@ -37,6 +37,9 @@ int sts_monobit(Test **test, int irun)
  int i;
  uint blens,nbits;
  Xtest ptest;
+ uint buf[DH_FILL_BLOCK];
+ uint nbuf = 0, ibuf = 0;
+ dh_context *ctx = test[0]->ctx;
 
  /*
   * for display only.  1 means monobit tests 1-tuples.
@@ -61,7 +64,7 @@ int sts_monobit(Test **test, int irun)
  /*
   * The number of bits per random integer tested.
   */
- blens = rmax_bits;
+ blens = ctx->rmax_bits;
  nbits = blens*test[0]->tsamples;
  ptest.y = 0.0;
  ptest.sigma = sqrt((double)nbits);
@@ -76,10 +79,16 @@ int sts_monobit(Test **test, int irun)
  ptest.x = 0;
 
  for(i=0;i<test[0]->tsamples;i++) {
+   if(ibuf == nbuf){
+     nbuf = test[0]->tsamples - i;
+     if(nbuf > DH_FILL_BLOCK) nbuf = DH_FILL_BLOCK;
+     dh_rng_fill(ctx->rng,buf,nbuf);
+     ibuf = 0;
+   }
 #if NOBITS
-   bitstring = gsl_rng_get(rng);
+   bitstring = buf[ibuf++];
 #else
-   uint n = gsl_rng_get(rng);
+   uint n = buf[ibuf++];
 #endif
    MYDEBUG(D_STS_MONOBIT) {
 #if NOBITS
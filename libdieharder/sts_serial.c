@@ -89,6 +89,8 @@ int sts_serial(Test **test,int irun)
  uint value;       /* value of sampled ntuple (as a uint) */
  uint mask;        /* mask in only nb bits */
  uint bi;          /* bit offset relative to window */
+ uint tsamples;    /* local copy of test[0]->tsamples */
+ dh_context *ctx = test[0]->ctx;
 
  /* Look for cruft below */
 
@@ -184,11 +186,12 @@ int sts_serial(Test **test,int irun)
   * fast gsl_rng_get() call, but we'll need to use the inline from the
   * static_get_rng routines in production.
   */
+ dh_bits_reserve(ctx,(off_t) tsamples*32);
  for(t=0;t<tsamples;t++){
    /* A bit slower per call, but won't fail for short rngs */
-   uintbuf[t] = get_rand_bits_uint(32,0xFFFFFFFF,rng);
+   uintbuf[t] = dh_bits_get32(ctx);
    /* Fast, but deadly to rngs with less than 32 bits returned */
-   /* uintbuf[t] = gsl_rng_get(rng); */
+   /* uintbuf[t] = gsl_rng_get(ctx->rng); */
    MYDEBUG(D_STS_SERIAL){
      printf("# sts_serial(): %u:  ",t);
      dumpuintbits(&uintbuf[t],1);